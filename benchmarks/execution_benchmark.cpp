@@ -0,0 +1,146 @@
+/*
+ *  Benchmarks for `cosim::execution`, i.e., the core simulation loop.
+ *
+ *  All benchmarks use synthetic systems of `mock_slave` instances, which do
+ *  (next to) no work of their own, so what is measured is the overhead of
+ *  the library: stepping, variable transfers, function calculations and
+ *  observers.
+ */
+#include "synthetic_system.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cosim/observer/last_value_observer.hpp>
+#include <cosim/observer/time_series_observer.hpp>
+
+#include <memory>
+
+
+namespace
+{
+
+constexpr auto time_series_buffer_size = 1000;
+
+synthetic_system system_from_args(const benchmark::State& state)
+{
+    auto sys = synthetic_system();
+    sys.slaveCount = static_cast<int>(state.range(0));
+    sys.connectionsPerSlave = static_cast<int>(state.range(1));
+    sys.functionCount = static_cast<int>(state.range(2));
+    sys.threadCount = static_cast<int>(state.range(3));
+    return sys;
+}
+
+void set_step_counters(benchmark::State& state, int slaveCount)
+{
+    state.SetItemsProcessed(state.iterations());
+    state.counters["slave_steps"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * slaveCount),
+        benchmark::Counter::kIsRate);
+}
+
+void step_args(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({"slaves", "conns", "funcs", "threads"});
+    b->ArgsProduct({{10, 100}, {0, 1, 4}, {0, 10}, {0, 1, 3}});
+}
+
+} // namespace
+
+
+// Throughput of `execution::step()` for various system sizes, numbers of
+// connections and functions, thread counts and worker pool types.
+template<cosim::worker_pool_type PoolType>
+void step(benchmark::State& state)
+{
+    auto sys = system_from_args(state);
+    sys.poolType = PoolType;
+    auto [execution, slaves] = make_execution(sys);
+    execution.initialize();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(execution.step());
+    }
+    set_step_counters(state, sys.slaveCount);
+}
+BENCHMARK_TEMPLATE(step, cosim::worker_pool_type::fork_join)
+    ->Apply(step_args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(step, cosim::worker_pool_type::task_queue)
+    ->Apply(step_args)
+    ->UseRealTime();
+
+
+// The cost of variable transfers, serial or parallel.  Compare with the
+// `conns:0` case to find the per-connection cost.
+void step_transfers(benchmark::State& state)
+{
+    auto sys = synthetic_system();
+    sys.slaveCount = static_cast<int>(state.range(0));
+    sys.connectionsPerSlave = static_cast<int>(state.range(1));
+    sys.threadCount = static_cast<int>(state.range(2));
+    sys.parallelTransfers = state.range(3) != 0;
+    auto [execution, slaves] = make_execution(sys);
+    execution.initialize();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(execution.step());
+    }
+    set_step_counters(state, sys.slaveCount);
+    state.counters["transfers"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * sys.slaveCount * sys.connectionsPerSlave),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(step_transfers)
+    ->ArgNames({"slaves", "conns", "threads", "parallel"})
+    ->ArgsProduct({{100, 1000}, {0, 1, 4}, {0, 3}, {0, 1}})
+    ->UseRealTime();
+
+
+// The cost of observers.  `observer` is 0 for none, 1 for a
+// `last_value_observer` and 2 for a `time_series_observer` which observes
+// the real output of every slave.
+void step_observed(benchmark::State& state)
+{
+    auto sys = synthetic_system();
+    sys.slaveCount = static_cast<int>(state.range(0));
+    sys.threadCount = static_cast<int>(state.range(1));
+    auto [execution, slaves] = make_execution(sys);
+    const auto observerType = state.range(2);
+    if (observerType == 1) {
+        execution.add_observer(std::make_shared<cosim::last_value_observer>());
+    } else if (observerType == 2) {
+        const auto observer = std::make_shared<cosim::time_series_observer>(time_series_buffer_size);
+        execution.add_observer(observer);
+        for (const auto slave : slaves) {
+            observer->start_observing(
+                cosim::variable_id{slave, cosim::variable_type::real, mock_slave::real_out_reference});
+        }
+    }
+    execution.initialize();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(execution.step());
+    }
+    set_step_counters(state, sys.slaveCount);
+}
+BENCHMARK(step_observed)
+    ->ArgNames({"slaves", "threads", "observer"})
+    ->ArgsProduct({{10, 100}, {0, 3}, {0, 1, 2}})
+    ->UseRealTime();
+
+
+// The time it takes to initialize an execution, i.e., to set up the slaves
+// and propagate initial values through the system.
+void initialize(benchmark::State& state)
+{
+    const auto sys = system_from_args(state);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto exe = std::make_unique<synthetic_execution>(make_execution(sys));
+        state.ResumeTiming();
+        exe->execution.initialize();
+        state.PauseTiming();
+        exe.reset();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(initialize)
+    ->Apply(step_args)
+    ->UseRealTime();
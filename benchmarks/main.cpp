@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+#include <cosim/log/simple.hpp>
+
+
+int main(int argc, char** argv)
+{
+    // Keep the benchmark output readable, and the logging out of the timings.
+    cosim::log::setup_simple_console_logging();
+    cosim::log::set_global_output_level(cosim::log::warning);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ *  \file
+ *  Construction of synthetic systems for benchmarking.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_BENCHMARKS_SYNTHETIC_SYSTEM_HPP
+#define COSIM_BENCHMARKS_SYNTHETIC_SYSTEM_HPP
+
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm.hpp>
+#include <cosim/execution.hpp>
+#include <cosim/function/linear_transformation.hpp>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/// The shape of a synthetic system.
+struct synthetic_system
+{
+    /// The number of slaves.
+    int slaveCount = 1;
+
+    /**
+     *  The number of connections per slave, in the range [0, 4].
+     *
+     *  Each `mock_slave` has one input and one output of each variable type.
+     *  Connection number `c` links the outputs of that type (in the order
+     *  real, integer, boolean, string) of each slave to the corresponding
+     *  input of the next slave, in a ring.
+     */
+    int connectionsPerSlave = 1;
+
+    /**
+     *  The number of functions.
+     *
+     *  These are linear transformations whose inputs are connected to the
+     *  real outputs of the slaves, in round-robin fashion.
+     */
+    int functionCount = 0;
+
+    /// The number of worker threads used by the algorithm.
+    int threadCount = 0;
+
+    /// The type of worker pool used by the algorithm.
+    cosim::worker_pool_type poolType = cosim::worker_pool_type::fork_join;
+
+    /// Whether the algorithm performs transfers in parallel.
+    bool parallelTransfers = false;
+
+    /// The algorithm's base step size.
+    cosim::duration stepSize = cosim::to_duration(0.01);
+};
+
+
+/// An execution with a synthetic system.
+struct synthetic_execution
+{
+    cosim::execution execution;
+    std::vector<cosim::simulator_index> slaves;
+};
+
+
+/// Creates an execution with an algorithm and a system of the given shape.
+inline synthetic_execution make_execution(const synthetic_system& sys)
+{
+    auto algorithm = std::make_shared<cosim::fixed_step_algorithm>(
+        sys.stepSize,
+        static_cast<unsigned int>(sys.threadCount),
+        sys.poolType);
+    algorithm->set_parallel_transfers(sys.parallelTransfers);
+    auto execution = cosim::execution(cosim::time_point(), algorithm);
+
+    std::vector<cosim::simulator_index> slaves;
+    for (int i = 0; i < sys.slaveCount; ++i) {
+        slaves.push_back(execution.add_slave(
+            std::make_shared<mock_slave>([](double x) { return x + 1.0; }),
+            "slave" + std::to_string(i)));
+    }
+
+    constexpr std::array<cosim::variable_type, 4> types = {
+        cosim::variable_type::real,
+        cosim::variable_type::integer,
+        cosim::variable_type::boolean,
+        cosim::variable_type::string,
+    };
+    const auto connections = std::clamp(sys.connectionsPerSlave, 0, static_cast<int>(types.size()));
+    for (int c = 0; c < connections; ++c) {
+        // mock_slave uses the same references for all variable types.
+        for (int i = 0; i < sys.slaveCount; ++i) {
+            execution.connect_variables(
+                cosim::variable_id{slaves[i], types[c], mock_slave::real_out_reference},
+                cosim::variable_id{slaves[(i + 1) % sys.slaveCount], types[c], mock_slave::real_in_reference});
+        }
+    }
+
+    for (int f = 0; f < sys.functionCount; ++f) {
+        const auto fun = execution.add_function(
+            std::make_shared<cosim::linear_transformation_function>(1.0, 2.0));
+        execution.connect_variables(
+            cosim::variable_id{slaves[f % sys.slaveCount], cosim::variable_type::real, mock_slave::real_out_reference},
+            cosim::function_io_id{fun, cosim::variable_type::real, cosim::linear_transformation_function::in_io_reference});
+    }
+    return {std::move(execution), std::move(slaves)};
+}
+
+
+#endif // COSIM_BENCHMARKS_SYNTHETIC_SYSTEM_HPP
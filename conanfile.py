@@ -30,12 +30,14 @@ class LibcosimConan(ConanFile):
         "fPIC": [True, False],
         "proxyfmu": [True, False],
         "no_fmi_logging": [True, False],
+        "benchmarks": [True, False],
     }
     default_options = {
         "shared": True,
         "fPIC": True,
         "proxyfmu": False,
         "no_fmi_logging": False,
+        "benchmarks": False,
     }
 
     # Dependencies/requirements
@@ -52,10 +54,12 @@ class LibcosimConan(ConanFile):
                           transitive_libs=True)
         self.requires("yaml-cpp/[~0.8]")
         self.requires("xerces-c/[~3.2]")
+        if self.options.benchmarks:
+            self.requires("benchmark/[~1.8]")
 
     # Exports
     exports = "version.txt"
-    exports_sources = ("src/*", "include/*", "cmake/*", "data/*", "docs/*", "tests/*", "CHANGELOG.md", "CMakeLists.txt",
+    exports_sources = ("src/*", "include/*", "cmake/*", "data/*", "docs/*", "tests/*", "benchmarks/*", "CHANGELOG.md", "CMakeLists.txt",
                        "CONTRIBUTING.md", "LICENSE", "README.md", "version.txt")
 
     # Build steps
@@ -88,6 +92,7 @@ class LibcosimConan(ConanFile):
         tc = CMakeToolchain(self)
         tc.cache_variables["LIBCOSIM_BUILD_APIDOC"] = False
         tc.cache_variables["LIBCOSIM_BUILD_TESTS"] = self._is_tests_enabled()
+        tc.cache_variables["LIBCOSIM_BUILD_BENCHMARKS"] = self.options.benchmarks
         tc.cache_variables["LIBCOSIM_NO_FMI_LOGGING"] = self.options.no_fmi_logging
         tc.cache_variables["LIBCOSIM_WITH_PROXYFMU"] = self.options.proxyfmu
         tc.generate()
@@ -16,6 +16,7 @@
 #include <cosim/model_description.hpp>
 #include <cosim/observer/observer.hpp>
 #include <cosim/serialization.hpp>
+#include <cosim/step_metrics.hpp>
 #include <cosim/time.hpp>
 
 #include <functional>
@@ -27,6 +28,35 @@
 namespace cosim
 {
 
+/**
+ *  The kind of worker pool an algorithm uses to run simulators in parallel.
+ *
+ *  Algorithms which step their simulators in parallel take this as an
+ *  optional constructor argument.
+ */
+enum class worker_pool_type
+{
+    /**
+     *  A general-purpose task queue.
+     *
+     *  Each simulator operation is submitted as a separate task to a queue
+     *  shared by all worker threads.
+     */
+    task_queue,
+
+    /**
+     *  A fork/join pool tailored for the barrier-per-step pattern.
+     *
+     *  Each simulator is pinned to a fixed worker thread (or the calling
+     *  thread), and idle workers spin for a short while before going to
+     *  sleep.  This reduces the thread hand-off overhead per step, which
+     *  can dominate the step time for systems with many small simulators
+     *  and short step sizes.
+     */
+    fork_join
+};
+
+
 /**
  *  An interface for co-simulation algorithms.
  *
@@ -214,6 +244,17 @@ public:
      */
     virtual void import_state(const serialization::node& exportedState) = 0;
 
+    /**
+     *  Sets the object in which the algorithm should record step timing
+     *  metrics for the phases of a step that only the algorithm knows
+     *  about, i.e., function calculations and variable transfers.
+     *
+     *  Recording should only be done while `enabled()` is true.
+     *  This function is called before any simulators are added.  The
+     *  default implementation does nothing, i.e., does not record metrics.
+     */
+    virtual void set_step_metrics(std::shared_ptr<step_metrics> /*metrics*/) { }
+
     virtual ~algorithm() noexcept = default;
 };
 
@@ -12,6 +12,10 @@
 
 #include <cosim/algorithm/algorithm.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace cosim
 {
 
@@ -29,6 +33,26 @@ struct ecco_algorithm_params
     double i_gain;
 };
 
+/// Accumulated energy statistics for one side of a power bond.
+struct powerbond_energy_stats
+{
+    /// The number of time steps over which energy has been accumulated.
+    std::int64_t step_count = 0;
+
+    /// The sum of the energy transferred in all time steps.
+    double total = 0.0;
+
+    /// The mean energy transferred per time step.
+    double mean = 0.0;
+
+    /**
+     *  The mean energy transferred per time step in the most recent time
+     *  steps, as retained according to `ecco_algorithm::set_energy_window_size()`.
+     *  This is zero if no steps are retained.
+     */
+    double window_mean = 0.0;
+};
+
 /**
  *  A fixed-stepsize co-simulation algorithm.
  *
@@ -47,8 +71,14 @@ public:
      *
      *  \param workerThreadCount
      *      The number of worker threads to spawn for running FMUs
+     *
+     *  \param workerPoolType
+     *      The kind of worker pool used for running FMUs in parallel.
      */
-    explicit ecco_algorithm(ecco_algorithm_params params, std::optional<unsigned int> workerThreadCount = std::nullopt);
+    explicit ecco_algorithm(
+        ecco_algorithm_params params,
+        std::optional<unsigned int> workerThreadCount = std::nullopt,
+        worker_pool_type workerPoolType = worker_pool_type::task_queue);
 
     ~ecco_algorithm() noexcept;
 
@@ -72,6 +102,7 @@ public:
     std::pair<duration, std::unordered_set<simulator_index>> do_step(time_point currentT) override;
     serialization::node export_current_state() const override;
     void import_state(const serialization::node& exportedState) override;
+    void set_step_metrics(std::shared_ptr<step_metrics> metrics) override;
 
     /**
      * Adds a variable pair for the power residual calculation.
@@ -81,11 +112,90 @@ public:
     void add_power_bond(cosim::variable_id input_a, cosim::variable_id output_a, cosim::variable_id input_b, cosim::variable_id output_b);
 
     /**
-     * Retrieves the energies in the power bond for the given simulator index.add_variable_value
-     * \param simulator_index 
-     *      The index of the simulator. 
+     * Sets the number of per-step energies retained for each side of each
+     * power bond.
+     *
+     * The running totals and means in `powerbond_energy_stats` always cover
+     * all time steps, while the per-step energies are only kept for the
+     * `size` most recent steps.  The default is 0, i.e., none are kept.
+     * Shrinking the window discards the oldest energies.
+     */
+    void set_energy_window_size(std::size_t size);
+
+    /**
+     * Retrieves the retained per-step energies for one side of a power bond,
+     * oldest first.
+     *
+     * Unlike in earlier versions, this does not return the energies of all
+     * time steps, only those of the most recent steps retained according to
+     * `set_energy_window_size()`.  Since no energies are retained by default,
+     * this returns an empty vector unless a window size has been set.  Use
+     * `get_powerbond_energy_stats()` for totals covering all time steps.
+     *
+     * \param index
+     *      The power bond side, where `2*k` refers to side `a` and `2*k+1`
+     *      to side `b` of the `k`th power bond added with `add_power_bond()`.
+     *
+     * \see set_energy_window_size()
+     */
+    std::vector<double> get_powerbond_energies(std::size_t index) const;
+
+    /**
+     * Retrieves the accumulated energy statistics for one side of a power bond.
+     *
+     * \param index
+     *      The power bond side, as for `get_powerbond_energies()`.
+     */
+    powerbond_energy_stats get_powerbond_energy_stats(std::size_t index) const;
+
+    /**
+     * Enables or disables step rejection.
+     *
+     * Normally, a step is always accepted, and the error estimate only
+     * affects the size of the next step.  With step rejection enabled, the
+     * states of all simulators are saved before each step, and if the error
+     * estimate exceeds the tolerance, they are restored and the step is
+     * retried with a smaller step size, until it is within the tolerance or
+     * the minimum step size is reached.
+     *
+     * This requires that all simulators can save their state (see
+     * `simulator_capabilities::can_save_state`).  If they can't, a warning
+     * is logged and steps are accepted as usual.  Steps taken while any
+     * variable modifiers are active (e.g. overrides from a manipulator) are
+     * also accepted as usual, since states can't be saved then.  The saved
+     * states are released when a simulator is removed or step rejection is
+     * disabled, or otherwise along with the simulators.  Pipelined stepping (see
+     * `set_pipelined_stepping()`) is not used while steps may be rejected,
+     * since the transfers must wait until a step has been accepted.  This
+     * is disabled by default.
+     */
+    void set_step_rejection(bool enable);
+
+    /// Returns the number of steps that have been rejected and retried.
+    std::int64_t get_rejected_step_count() const;
+
+    /**
+     * Enables or disables parallel variable transfers and function calculations.
+     *
+     * When enabled, the transfers that follow each time step are partitioned
+     * by their target simulator or function, and the partitions are processed
+     * concurrently on the worker pool, as are the function calculations.
+     * This is disabled by default.
+     */
+    void set_parallel_transfers(bool enable);
+
+    /**
+     * Enables or disables pipelined stepping.
+     *
+     * Normally, variable transfers and function calculations start when all
+     * simulators have completed their time steps.  In pipelined mode, the
+     * transfers to a simulator or function instead start on the worker thread
+     * that completes the last step they depend on, so they overlap with the
+     * time steps of other simulators.  The results are the same in both
+     * modes.  This is disabled by default, and takes precedence over
+     * `set_parallel_transfers()`.
      */
-    std::vector<double> get_powerbond_energies(cosim::simulator_index simulator_index);
+    void set_pipelined_stepping(bool enable);
 
 private:
     class impl;
@@ -38,9 +38,18 @@ public:
      *
      *  \param workerThreadCount
      *      The number of worker threads to spawn for running FMUs
+     *
+     *  \param workerPoolType
+     *      The kind of worker pool used for running FMUs in parallel.
      */
-    explicit fixed_step_algorithm(duration baseStepSize, std::optional<unsigned int> workerThreadCount = std::nullopt);
-    explicit fixed_step_algorithm(fixed_step_algorithm_params params, std::optional<unsigned int> workerThreadCount = std::nullopt);
+    explicit fixed_step_algorithm(
+        duration baseStepSize,
+        std::optional<unsigned int> workerThreadCount = std::nullopt,
+        worker_pool_type workerPoolType = worker_pool_type::task_queue);
+    explicit fixed_step_algorithm(
+        fixed_step_algorithm_params params,
+        std::optional<unsigned int> workerThreadCount = std::nullopt,
+        worker_pool_type workerPoolType = worker_pool_type::task_queue);
 
     ~fixed_step_algorithm() noexcept;
 
@@ -64,6 +73,7 @@ public:
     std::pair<duration, std::unordered_set<simulator_index>> do_step(time_point currentT) override;
     serialization::node export_current_state() const override;
     void import_state(const serialization::node& exportedState) override;
+    void set_step_metrics(std::shared_ptr<step_metrics> metrics) override;
 
     /**
      * Sets step size decimation factor for a simulator.
@@ -80,6 +90,29 @@ public:
      */
     void set_stepsize_decimation_factor(simulator_index simulator, int factor);
 
+    /**
+     * Enables or disables parallel variable transfers and function calculations.
+     *
+     * When enabled, the transfers that follow each time step are partitioned
+     * by their target simulator or function, and the partitions are processed
+     * concurrently on the worker pool, as are the function calculations.
+     * This is disabled by default.
+     */
+    void set_parallel_transfers(bool enable);
+
+    /**
+     * Enables or disables pipelined stepping.
+     *
+     * Normally, variable transfers and function calculations start when all
+     * simulators have completed their time steps.  In pipelined mode, the
+     * transfers to a simulator or function instead start on the worker thread
+     * that completes the last step they depend on, so they overlap with the
+     * time steps of other simulators.  The results are the same in both
+     * modes.  This is disabled by default, and takes precedence over
+     * `set_parallel_transfers()`.
+     */
+    void set_pipelined_stepping(bool enable);
+
 private:
     class impl;
     std::unique_ptr<impl> pimpl_;
@@ -16,7 +16,9 @@
 #include <cosim/time.hpp>
 
 #include <functional>
+#include <istream>
 #include <optional>
+#include <ostream>
 #include <string_view>
 #include <unordered_set>
 
@@ -60,6 +62,46 @@ public:
      */
     virtual void set_string(value_reference reference, std::string_view value) = 0;
 
+    /**
+     *  Sets the value of the real variable in the given slot.
+     *
+     *  The default implementation forwards to `set_real(value_reference, double)`.
+     */
+    virtual void set_real(variable_slot slot, double value)
+    {
+        set_real(slot.reference, value);
+    }
+
+    /**
+     *  Sets the value of the integer variable in the given slot.
+     *
+     *  The default implementation forwards to `set_integer(value_reference, int)`.
+     */
+    virtual void set_integer(variable_slot slot, int value)
+    {
+        set_integer(slot.reference, value);
+    }
+
+    /**
+     *  Sets the value of the boolean variable in the given slot.
+     *
+     *  The default implementation forwards to `set_boolean(value_reference, bool)`.
+     */
+    virtual void set_boolean(variable_slot slot, bool value)
+    {
+        set_boolean(slot.reference, value);
+    }
+
+    /**
+     *  Sets the value of the string variable in the given slot.
+     *
+     *  The default implementation forwards to `set_string(value_reference, std::string_view)`.
+     */
+    virtual void set_string(variable_slot slot, std::string_view value)
+    {
+        set_string(slot.reference, value);
+    }
+
     /**
      *  Performs pre-simulation setup, instantiates the FMUs and enters 
      *  initialisation mode. 
@@ -121,6 +163,18 @@ public:
      */
     virtual void start_simulation() = 0;
 
+    /**
+     *  Informs the simulator of the step number at which the next time step
+     *  completes.
+     *
+     *  This is used to determine which of the variables exposed with
+     *  `expose_for_periodic_getting()` must be retrieved after the step.
+     *  It only applies to the next `do_step()` call, and if it has not been
+     *  called, all exposed variables are retrieved.  The default
+     *  implementation does nothing.
+     */
+    virtual void set_next_step_number(step_number /*n*/) { }
+
     /**
      *  Performs a single time step.
      *
@@ -201,6 +255,30 @@ public:
      *  been saved by a simulator of the same or a compatible type.
      */
     virtual state_index import_state(const serialization::node& exportedState) = 0;
+
+    /**
+     *  Exports a saved state directly to a binary stream.
+     *
+     *  This is a faster alternative to `export_state()` for when the state
+     *  is only going to be read back with `import_state_binary()`.  The
+     *  default implementation writes the result of `export_state()` with
+     *  `serialization::write_binary()`.
+     */
+    virtual void export_state_binary(state_index stateIndex, std::ostream& out) const
+    {
+        serialization::write_binary(out, export_state(stateIndex));
+    }
+
+    /**
+     *  Imports a state exported with `export_state_binary()`.
+     *
+     *  This works like `import_state()`, and the data must be read from the
+     *  stream position at which `export_state_binary()` started writing.
+     */
+    virtual state_index import_state_binary(std::istream& in)
+    {
+        return import_state(serialization::read_binary(in));
+    }
 };
 
 } // namespace cosim
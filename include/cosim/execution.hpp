@@ -13,6 +13,7 @@
 #include <cosim/function/function.hpp>
 #include <cosim/model_description.hpp>
 #include <cosim/slave.hpp>
+#include <cosim/step_metrics.hpp>
 #include <cosim/system_structure.hpp>
 #include <cosim/time.hpp>
 #include <cosim/timer.hpp>
@@ -21,8 +22,10 @@
 
 #include <cstdint>
 #include <future>
+#include <istream>
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <sstream>
 #include <unordered_map>
 
@@ -336,8 +339,25 @@ public:
     /// Returns a pointer to an object containing real time metrics
     std::shared_ptr<const real_time_metrics> get_real_time_metrics() const;
 
+    /**
+     *  Enables or disables collection of step timing metrics
+     *  (thread-safe operation).
+     *
+     *  Collection is disabled by default, as it adds a small overhead to
+     *  each step.
+     */
+    void enable_step_metrics(bool enable = true);
+
+    /**
+     *  Returns a pointer to an object containing step timing metrics.
+     *
+     *  The metrics are only updated while collection is enabled with
+     *  `enable_step_metrics()`.
+     */
+    std::shared_ptr<const step_metrics> get_step_metrics() const;
+
     /// Returns the model description for a simulator with the given index
-    model_description get_model_description(simulator_index index) const;
+    std::shared_ptr<const model_description> get_model_description(simulator_index index) const;
 
     /// Returns a map of currently modified variables
     std::vector<variable_id> get_modified_variables() const;
@@ -380,6 +400,34 @@ public:
      */
     void import_state(const serialization::node& exportedState);
 
+    /**
+     *  Exports the current state of the co-simulation to a binary stream.
+     *
+     *  This writes the same information as `export_current_state()`, but
+     *  streams it in a compact binary format, where the variable values of
+     *  each simulator are stored as typed arrays.  This is considerably
+     *  faster for large systems, but the data can only be read back with
+     *  `import_state(std::istream&)` on a platform with the same byte order
+     *  and type sizes.
+     *
+     *  \pre `initialize()` has been called.
+     *  \pre `!is_running()`
+     */
+    void export_current_state(std::ostream& out) const;
+
+    /**
+     *  Imports a co-simulation state written with
+     *  `export_current_state(std::ostream&)`.
+     *
+     *  The same requirements on the system structure apply as for
+     *  `import_state(const serialization::node&)`.  In addition, the
+     *  simulators must have been added in the same order.
+     *
+     *  \pre `initialize()` has been called.
+     *  \pre `!is_running()`
+     */
+    void import_state(std::istream& in);
+
 private:
     class impl;
     std::unique_ptr<impl> pimpl_;
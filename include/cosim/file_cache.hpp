@@ -12,6 +12,8 @@
 #include <cosim/fs_portability.hpp>
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 
 
@@ -84,17 +86,51 @@ public:
      */
     virtual std::unique_ptr<directory_ro> get_directory_ro(std::string_view key) = 0;
 
+    /**
+     *  Returns whether the cache has an index; see `get_index_entry()`.
+     *
+     *  The default implementation returns `false`.
+     */
+    virtual bool has_index() const noexcept { return false; }
+
+    /**
+     *  Returns the value stored under `key` in the cache's index, if any.
+     *
+     *  The index is a small key-value store in which client code can record
+     *  information about the cache contents, e.g. which file the contents
+     *  of a subdirectory were unpacked from, so that it doesn't need to be
+     *  recomputed the next time.  Entries may disappear at any time, e.g.
+     *  when the cache is cleaned up, so client code must be prepared to
+     *  recompute them.
+     *
+     *  The default implementation always returns nothing.
+     */
+    virtual std::optional<std::string> get_index_entry(std::string_view /*key*/)
+    {
+        return std::nullopt;
+    }
+
+    /**
+     *  Stores `value` under `key` in the cache's index, replacing any
+     *  previous value.
+     *
+     *  The default implementation does nothing.
+     */
+    virtual void set_index_entry(std::string_view /*key*/, std::string_view /*value*/) { }
+
     virtual ~file_cache() = default;
 };
 
 
 /**
- *  A simple implementation of `file_cache` that offers no synchronisation
- *  or persistence.
+ *  A simple implementation of `file_cache` that offers no interprocess
+ *  synchronisation or persistence.
  *
  *  Upon construction, a new cache will be created in a randomly-named
  *  temporary location, and it will be removed again on destruction.
- *  The class may only be safely used by one thread at a time.
+ *  Different subdirectories may be requested by multiple threads
+ *  concurrently, but a subdirectory which is in use for writing may not
+ *  be requested again until it is released.
  */
 class temporary_file_cache : public file_cache
 {
@@ -140,11 +176,24 @@ public:
     std::unique_ptr<directory_rw> get_directory_rw(std::string_view key) override;
     std::unique_ptr<directory_ro> get_directory_ro(std::string_view key) override;
 
+    /**
+     *  Returns `true`.
+     *
+     *  The index is stored in the cache root directory, with one small file
+     *  per entry, so looking up or updating an entry doesn't get slower as
+     *  the index grows.  It is shared by all processes that use the cache.
+     */
+    bool has_index() const noexcept override { return true; }
+
+    std::optional<std::string> get_index_entry(std::string_view key) override;
+    void set_index_entry(std::string_view key, std::string_view value) override;
+
     /**
      *  Cleans up cache contents.
      *
      *  This will delete all subdirectories that are not currently being
-     *  used (i.e., for which there exist `directory_r[ow]` handles).
+     *  used (i.e., for which there exist `directory_r[ow]` handles), and
+     *  clear the index.
      */
     void cleanup();
 
@@ -13,9 +13,13 @@
 #include <cosim/file_cache.hpp>
 #include <cosim/fs_portability.hpp>
 
+#include <exception>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 
 // Forward declarations to avoid external dependency on FMI Library.
@@ -30,6 +34,7 @@ namespace fmi
 {
 
 class fmu;
+enum class fmi_version;
 
 
 /**
@@ -38,6 +43,12 @@ class fmu;
  *  The main purpose of this class is to read FMU files and create
  *  `cosim::fmi::fmu` objects to represent them.  This is done with the
  *  `import()` function.
+ *
+ *  `import()` and `import_unpacked()` may be called concurrently from
+ *  multiple threads, in which case distinct FMUs are unpacked in parallel.
+ *  Concurrent imports of the same FMU are coalesced, so that it is only
+ *  unpacked once.  The FMI Library context is not thread safe, however, so
+ *  the parsing of model descriptions is serialised.
  */
 class importer : public std::enable_shared_from_this<importer>
 {
@@ -71,10 +82,16 @@ public:
      *
      *  \param [in] fmuPath
      *      The path to the FMU file.
+     *  \param [in] maxThreads
+     *      The maximum number of threads used to unpack the FMU.  Callers
+     *      which run several imports concurrently should divide their
+     *      thread budget between them.
      *  \returns
      *      An object which represents the imported FMU.
      */
-    std::shared_ptr<fmu> import(const cosim::filesystem::path& fmuPath);
+    std::shared_ptr<fmu> import(
+        const cosim::filesystem::path& fmuPath,
+        unsigned int maxThreads = std::thread::hardware_concurrency());
 
     /**
      *  Imports and loads an FMU that has already been unpacked.
@@ -98,6 +115,26 @@ public:
     fmi_import_context_t* fmilib_handle() const;
 
 private:
+    // Creates an `fmu` object for an unpacked FMU, with exclusive access to
+    // the FMI Library context.
+    std::shared_ptr<fmu> load_unpacked(
+        fmi_version version,
+        std::unique_ptr<file_cache::directory_ro> fmuDir);
+
+    // Returns the cached `fmu` object with the given GUID, if any.  If it is
+    // currently being imported by another thread, waits for that to finish.
+    // Otherwise, registers the calling thread as the importer, and returns
+    // null.  The caller must then call `finish_import()`.
+    std::shared_ptr<fmu> find_or_begin_import(const std::string& guid);
+
+    // Publishes the result of an import started with
+    // `find_or_begin_import()`.  `fmuObj` is null if the import failed.
+    void finish_import(
+        const std::string& guid,
+        const cosim::filesystem::path* fmuPath,
+        std::shared_ptr<fmu> fmuObj,
+        std::exception_ptr error);
+
     void prune_ptr_caches();
 
     // Note: The order of these declarations is important!
@@ -105,8 +142,21 @@ private:
     std::unique_ptr<jm_callbacks> callbacks_;
     std::unique_ptr<fmi_import_context_t, void (*)(fmi_import_context_t*)> handle_;
 
+    // Guards `handle_` and `callbacks_`, and thereby FMI Library calls.
+    std::mutex fmilibMutex_;
+
+    // Guards the caches below.
+    std::mutex cacheMutex_;
     std::map<cosim::filesystem::path, std::weak_ptr<fmu>> pathCache_;
     std::map<std::string, std::weak_ptr<fmu>> guidCache_;
+
+    // Imports which are in progress, by GUID.
+    struct pending_import
+    {
+        std::promise<std::shared_ptr<fmu>> promise;
+        std::shared_future<std::shared_ptr<fmu>> result = promise.get_future().share();
+    };
+    std::map<std::string, pending_import> pendingImports_;
 };
 
 
@@ -33,9 +33,14 @@ public:
      *  function call doesn't trigger a new data exchange.
      *
      *  Calling this function more than once for the same variable has no
-     *  effect.
+     *  effect, and returns the same slot.
+     *
+     *  \returns
+     *      A slot which can subsequently be passed to the `simulator::set_xxx()`
+     *      overloads that take a `variable_slot`.  The slot remains valid for
+     *      the lifetime of the object.
      */
-    virtual void expose_for_setting(variable_type, value_reference) = 0;
+    virtual variable_slot expose_for_setting(variable_type, value_reference) = 0;
 
     /**
      *  Sets a modifier for the value of a real input variable.
@@ -10,11 +10,14 @@
 #ifndef COSIM_MODEL_HPP
 #define COSIM_MODEL_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -210,6 +213,73 @@ struct model_description
 /// Getter for returning a variable description.
 std::optional<variable_description> find_variable(const model_description& description, const std::string& variable_name);
 
+
+/**
+ *  An index for fast lookup of the variables in a model description.
+ *
+ *  Variables can be looked up by name, or by type and value reference, in
+ *  constant time.  The index is built once, and shares ownership of the
+ *  model description, which must not be modified afterwards.
+ *
+ *  Several variables may have the same type and value reference, e.g.
+ *  aliases in FMI.  Lookups by reference consider such variables in the
+ *  order in which they appear in the model description.
+ */
+class variable_lookup
+{
+public:
+    /// Builds an index of the variables in `description`.
+    explicit variable_lookup(std::shared_ptr<const model_description> description);
+
+    /// Returns the indexed model description.
+    const model_description& description() const noexcept
+    {
+        return *description_;
+    }
+
+    /**
+     *  Returns the first variable with the given name, or `nullptr` if
+     *  there is none.
+     */
+    const variable_description* find(std::string_view name) const;
+
+    /**
+     *  Returns the first variable with the given type and value reference,
+     *  or `nullptr` if there is none.
+     */
+    const variable_description* find(variable_type type, value_reference reference) const;
+
+    /**
+     *  Returns the first variable with the given type, value reference and
+     *  causality, or `nullptr` if there is none.
+     */
+    const variable_description* find(
+        variable_type type,
+        value_reference reference,
+        variable_causality causality) const;
+
+private:
+    // A range in `byReference_`.
+    struct reference_range
+    {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    static std::uint64_t reference_key(variable_type type, value_reference reference) noexcept
+    {
+        return (static_cast<std::uint64_t>(type) << 32) | reference;
+    }
+
+    std::shared_ptr<const model_description> description_;
+    std::unordered_map<std::string_view, const variable_description*> byName_;
+
+    // The variables sorted by type and reference, in their original order
+    // within each group of aliases, and the range of each group.
+    std::vector<const variable_description*> byReference_;
+    std::unordered_map<std::uint64_t, reference_range> referenceRanges_;
+};
+
 /// Possible outcomes of a subsimulator time step
 enum class step_result
 {
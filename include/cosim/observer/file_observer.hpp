@@ -14,6 +14,8 @@
 #include <cosim/observer/observer.hpp>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -25,6 +27,81 @@ namespace cosim
 class file_observer;
 
 
+/**
+ *  File formats supported by `file_observer`.
+ */
+enum class file_observer_format
+{
+    /**
+     *  Comma-separated values, one row per logged step, with a header row
+     *  containing the variable names.  Files have the extension `.csv`.
+     */
+    csv,
+
+    /**
+     *  A compact binary columnar format, suitable for logging large numbers
+     *  of variables at high rates.  Files have the extension `.bin`.
+     *
+     *  All integers and floating-point numbers are stored in the byte order
+     *  of the host (which may be detected using the byte order mark in the
+     *  header), strings are stored as a `uint32` byte count followed by the
+     *  UTF-8 bytes, and booleans as one `uint8` each.  A file consists of
+     *  one or more *segments* (a new one is started each time recording is
+     *  (re)started), each of which has the following layout:
+     *
+     *  1. Header:
+     *     - `char[8]`: magic number, `"COSIMLOG"`
+     *     - `uint32`: format version, currently 1
+     *     - `uint32`: byte order mark, `0x01020304`
+     *     - strings: simulator name, model name and model UUID
+     *     - `uint32[4]`: the number of real, integer, boolean and string
+     *       variables, in that order
+     *     - for each variable, in the same type order: its name (string),
+     *       value reference (`uint32`), causality (string) and
+     *       variability (string)
+     *  2. Zero or more blocks of `R` rows each:
+     *     - `char[4]`: magic number, `"BLCK"`
+     *     - `uint32`: the number of rows, `R`
+     *     - `uint64`: the number of bytes in the rest of the block
+     *     - `int64[R]`: step numbers
+     *     - `int64[R]`: simulation times, in nanoseconds
+     *     - one column of `R` values per variable, in the same order as in
+     *       the header: `double` for reals, `int32` for integers, `uint8`
+     *       for booleans and strings for strings
+     *  3. Block index, written when recording stops:
+     *     - `uint64`: the number of blocks
+     *     - for each block: its offset from the start of the segment
+     *       (`uint64`), its first step number (`int64`) and its number of
+     *       rows (`uint32`)
+     *  4. Trailer:
+     *     - `uint64`: the offset of the block index from the start of the
+     *       segment
+     *     - `uint64`: the total size of the segment, including the trailer
+     *     - `char[8]`: magic number, `"COSIMIDX"`
+     *
+     *  The trailer makes it possible to find the block index, and the start
+     *  of the segment, by reading from the end of the file.  If the index
+     *  is missing (e.g. because the process crashed), the blocks can still
+     *  be read sequentially.
+     */
+    binary
+};
+
+
+/**
+ *  What `file_observer` does when the buffer of an asynchronously written
+ *  log is full.  See `file_observer_config::set_asynchronous_writing()`.
+ */
+enum class file_observer_overflow_policy
+{
+    /// Wait for the writer thread to make room in the buffer.
+    block,
+
+    /// Discard the new sample.
+    drop
+};
+
+
 /**
  * Configuration options for file_observer.
  */
@@ -101,10 +178,50 @@ public:
         precision_ = precision;
     }
 
+    /**
+     * Specify the format of the generated files
+     *
+     * \param format the file format, `file_observer_format::csv` by default
+     * \return self
+     */
+    file_observer_config& set_output_format(file_observer_format format)
+    {
+        format_ = format;
+        return *this;
+    }
+
+    /**
+     * Specify that files should be written asynchronously
+     *
+     * By default, values are formatted and written to file in the thread that
+     * completes each step. With asynchronous writing, they are instead copied
+     * into a preallocated ring buffer for each simulator, and a background
+     * thread formats and writes them. This keeps disk latency off the
+     * simulation's critical path, while bounding the memory used for
+     * buffering. If writing fails on the background thread, the first such
+     * error is rethrown by the next step or by `file_observer::stop_recording()`.
+     *
+     * \param bufferSize the number of samples (logged steps) which can be
+     *      buffered per simulator, or zero to write synchronously (default)
+     * \param policy what to do when a buffer is full
+     * \return self
+     */
+    file_observer_config& set_asynchronous_writing(
+        std::size_t bufferSize,
+        file_observer_overflow_policy policy = file_observer_overflow_policy::block)
+    {
+        asyncBufferSize_ = bufferSize;
+        overflowPolicy_ = policy;
+        return *this;
+    }
+
 private:
     bool timeStampedFileNames_{true};
     size_t defaultDecimationFactor_{1};
     int precision_{-1};
+    file_observer_format format_{file_observer_format::csv};
+    std::size_t asyncBufferSize_{0};
+    file_observer_overflow_policy overflowPolicy_{file_observer_overflow_policy::block};
 
     std::unordered_map<std::string, std::pair<size_t, std::vector<std::string>>> variablesToLog_;
 
@@ -118,7 +235,8 @@ private:
 
 
 /**
- * An observer implementation, for saving observed variable values to file in csv format.
+ * An observer implementation, for saving observed variable values to file in csv format,
+ * or optionally in a binary format (see `file_observer_format`).
  *
  * Recording may be toggled on or off mid simulation. This functionality is thread safe.
  */
@@ -189,6 +307,15 @@ public:
 
     cosim::filesystem::path get_log_path();
 
+    /**
+     * Returns the number of samples which have been discarded because the
+     * buffer was full, when writing asynchronously with the
+     * `file_observer_overflow_policy::drop` policy.
+     *
+     * This method can safely be called from different threads.
+     */
+    std::uint64_t get_dropped_sample_count() const;
+
     ~file_observer() override;
 
 private:
@@ -197,16 +324,21 @@ private:
         std::vector<variable_description> variables;
         size_t decimationFactor;
         bool timeStampedFileNames;
+        file_observer_format format;
     };
 
     simulator_logging_config parse_config(const std::string& simulatorName);
 
     class slave_value_writer;
+    class async_writer;
     std::unordered_map<simulator_index, std::unique_ptr<slave_value_writer>> valueWriters_;
     std::unordered_map<simulator_index, observable*> simulators_;
     std::optional<file_observer_config> config_;
     cosim::filesystem::path logDir_;
     std::atomic<bool> recording_ = true;
+    // Declared after `valueWriters_`, so that the writer thread is stopped
+    // before the value writers are destroyed.
+    std::unique_ptr<async_writer> asyncWriter_;
 };
 
 
@@ -27,12 +27,26 @@ class slave_value_provider;
 
 /**
  *  An observer implementation, storing the last observed variable values in memory.
+ *
+ *  By default, all variables of all simulators are observed.  Since this
+ *  means that the values of all variables must be retrieved from the
+ *  subsimulators after every step, it may be costly for models with many
+ *  variables.  The observer may instead be created in a mode where only the
+ *  variables that are explicitly requested with `start_observing()` are
+ *  observed.
  */
 class last_value_observer : public last_value_provider
 {
 public:
+    /// Creates an observer which observes all variables.
     last_value_observer();
 
+    /**
+     * Creates an observer which observes all variables if `observeAllVariables`
+     * is true, or only those requested with `start_observing()` otherwise.
+     */
+    explicit last_value_observer(bool observeAllVariables);
+
     void simulator_added(simulator_index, observable*, time_point) override;
 
     void simulator_removed(simulator_index, time_point) override;
@@ -58,6 +72,39 @@ public:
 
     void state_restored(step_number currentStep, time_point currentTime) override;
 
+    /**
+     * Start observing a variable.
+     *
+     * Its value will be available from the `get_xxx()` methods once the
+     * simulator has completed its next time step (or initialization).
+     *
+     * \pre
+     *      The execution is not stepping, i.e., `!execution.is_running()`
+     *      and no call to `execution::step()` is in progress.  This is
+     *      because the variable may have to be exposed in the simulator,
+     *      which must not happen while it retrieves variable values.
+     *
+     * \throws std::invalid_argument
+     *      if the variable's type is not real, integer, boolean or string.
+     */
+    void start_observing(variable_id id);
+
+    /**
+     * Stop observing a variable.
+     *
+     * Its value will no longer be available from the `get_xxx()` methods
+     * after the simulator's next time step.  Note that the simulator may
+     * still retrieve the variable's value from the subsimulator after each
+     * step, since there is no way to undo `observable::expose_for_getting()`.
+     *
+     * \pre
+     *      The execution is not stepping, as for `start_observing()`.
+     *
+     * \throws std::invalid_argument
+     *      if the variable's type is not real, integer, boolean or string.
+     */
+    void stop_observing(variable_id id);
+
     void get_real(
         simulator_index sim,
         gsl::span<const value_reference> variables,
@@ -81,6 +128,7 @@ public:
     ~last_value_observer() noexcept override;
 
 private:
+    bool observeAllVariables_ = true;
     std::unordered_map<simulator_index, std::unique_ptr<slave_value_provider>> valueProviders_;
 };
 
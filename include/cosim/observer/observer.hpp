@@ -14,6 +14,8 @@
 #include <cosim/model_description.hpp>
 #include <cosim/time.hpp>
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -21,6 +23,25 @@
 namespace cosim
 {
 
+/**
+ *  A handle to an exposed variable.
+ *
+ *  Slots are returned by `observable::expose_for_getting()` and
+ *  `manipulable::expose_for_setting()`, and allow repeated access to the
+ *  variable's value without a lookup by value reference.  A slot is only
+ *  meaningful for the object that returned it, and for the same variable type
+ *  and direction (getting or setting).
+ */
+struct variable_slot
+{
+    /// The slot's position in the object's internal variable cache.
+    std::size_t index = 0;
+
+    /// The value reference of the variable.
+    value_reference reference = 0;
+};
+
+
 /// Interface for observable entities in a simulation.
 class observable
 {
@@ -28,8 +49,13 @@ public:
     /// Returns the entity's name.
     virtual std::string name() const = 0;
 
-    /// Returns a description of the entity.
-    virtual cosim::model_description model_description() const = 0;
+    /**
+     *  Returns a description of the entity.
+     *
+     *  The description is shared and immutable, so this is cheap to call,
+     *  and the returned object remains valid for as long as it is referenced.
+     */
+    virtual std::shared_ptr<const cosim::model_description> model_description() const = 0;
 
     /**
      *  Exposes a variable for retrieval with `get_xxx()`.
@@ -37,8 +63,38 @@ public:
      *  The purpose is fundamentally to select which variables get transferred
      *  from remote simulators at each step, so that each individual `get_xxx()`
      *  function call doesn't trigger a separate RPC operation.
+     *
+     *  Calling this function more than once for the same variable has no
+     *  effect, and returns the same slot.
+     *
+     *  \returns
+     *      A slot which can subsequently be passed to the `get_xxx()`
+     *      overloads that take a `variable_slot`.  The slot remains valid for
+     *      the lifetime of the object.
      */
-    virtual void expose_for_getting(variable_type, value_reference) = 0;
+    virtual variable_slot expose_for_getting(variable_type, value_reference) = 0;
+
+    /**
+     *  Exposes a variable for retrieval with `get_xxx()`, declaring that its
+     *  value is only needed after time steps whose step numbers are
+     *  multiples of `period`.
+     *
+     *  This allows the entity to skip retrieving the variable after other
+     *  steps, in which case `get_xxx()` returns the value from an earlier
+     *  step.  If the same variable is exposed several times, its value is
+     *  kept up to date for all of the requested periods, and
+     *  `expose_for_getting()` counts as a period of 1.
+     *
+     *  The default implementation ignores `period` and forwards to
+     *  `expose_for_getting()`.
+     */
+    virtual variable_slot expose_for_periodic_getting(
+        variable_type type,
+        value_reference reference,
+        step_number /*period*/)
+    {
+        return expose_for_getting(type, reference);
+    }
 
     /**
      *  Returns the value of a real variable.
@@ -71,6 +127,49 @@ public:
      */
     virtual std::string_view get_string(value_reference) const = 0;
 
+    /**
+     *  Returns the value of the real variable in the given slot.
+     *
+     *  The default implementation forwards to `get_real(value_reference)`.
+     */
+    virtual double get_real(variable_slot slot) const
+    {
+        return get_real(slot.reference);
+    }
+
+    /**
+     *  Returns the value of the integer variable in the given slot.
+     *
+     *  The default implementation forwards to `get_integer(value_reference)`.
+     */
+    virtual int get_integer(variable_slot slot) const
+    {
+        return get_integer(slot.reference);
+    }
+
+    /**
+     *  Returns the value of the boolean variable in the given slot.
+     *
+     *  The default implementation forwards to `get_boolean(value_reference)`.
+     */
+    virtual bool get_boolean(variable_slot slot) const
+    {
+        return get_boolean(slot.reference);
+    }
+
+    /**
+     *  Returns the value of the string variable in the given slot.
+     *
+     *  The returned `std::string_view` is only guaranteed to remain valid
+     *  until the next call of this or any other of the object's methods.
+     *
+     *  The default implementation forwards to `get_string(value_reference)`.
+     */
+    virtual std::string_view get_string(variable_slot slot) const
+    {
+        return get_string(slot.reference);
+    }
+
     virtual ~observable() noexcept { }
 };
 
@@ -26,6 +26,36 @@ namespace cosim
 class slave_value_provider;
 
 
+/**
+ *  A query for two time-synchronized series of observed values for two real
+ *  variables.  See `time_series_observer::get_synchronized_real_series()`.
+ */
+struct synchronized_real_series_query
+{
+    /// Index of the first simulator.
+    simulator_index sim1;
+
+    /// The first value reference.
+    value_reference valueReference1;
+
+    /// Index of the second simulator.
+    simulator_index sim2;
+
+    /// The second value reference.
+    value_reference valueReference2;
+
+    /// The step number to start from.
+    step_number fromStep;
+
+    /// [out] The first series of observed values.
+    gsl::span<double> values1;
+
+    /// [out] The second series of observed values.
+    gsl::span<double> values2;
+};
+
+
+
 /**
  *  An observer implementation, storing all observed variable values for a user-specified set of variables in memory.
  */
@@ -118,6 +148,21 @@ public:
         gsl::span<double> values1,
         gsl::span<double> values2) override;
 
+    /**
+     * Retrieves several pairs of time-synchronized series of observed values
+     * for real variables.
+     *
+     * This is equivalent to calling `get_synchronized_real_series()` for each
+     * of the `queries`, except that all of the series are read in one
+     * consistent snapshot, i.e., no samples are added while they are read.
+     *
+     * \param [in] queries the series to read
+     * \param [out] samplesRead the number of samples read for each query
+     */
+    void get_synchronized_real_series(
+        gsl::span<const synchronized_real_series_query> queries,
+        gsl::span<std::size_t> samplesRead);
+
     ~time_series_observer() noexcept override;
 
 private:
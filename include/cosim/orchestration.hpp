@@ -17,7 +17,9 @@
 #include <cosim/uri.hpp>
 
 #include <memory>
+#include <mutex>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 
@@ -91,6 +93,28 @@ public:
      *      An (absolute) model URI.
      */
     virtual std::shared_ptr<model> lookup_model(const uri& modelUri) = 0;
+
+    /**
+     *  Tries to resolve a model URI relative to some base URI, using at most
+     *  `maxThreads` threads for the work involved.
+     *
+     *  This is called by `model_uri_resolver::lookup_models()`, which
+     *  divides its thread budget between concurrent lookups.  The default
+     *  implementation ignores `maxThreads` and forwards to
+     *  `lookup_model(baseUri, modelUriReference)`.
+     */
+    virtual std::shared_ptr<model> lookup_model(
+        const uri& baseUri,
+        const uri& modelUriReference,
+        unsigned int maxThreads);
+
+    /**
+     *  Returns whether `lookup_model()` may be called concurrently from
+     *  multiple threads.
+     *
+     *  The default implementation returns `false`.
+     */
+    virtual bool supports_concurrent_lookups() const noexcept { return false; }
 };
 
 
@@ -163,7 +187,41 @@ public:
      */
     std::shared_ptr<model> lookup_model(const uri& modelUri);
 
+    /**
+     *  Resolves several model URI references relative to the same base URI.
+     *
+     *  This is equivalent to calling `lookup_model(baseUri, r)` for each
+     *  element `r` of `modelUriReferences`, except that the lookups are
+     *  performed concurrently, on up to `maxThreads` threads.  Calls into
+     *  sub-resolvers which don't support concurrent lookups (see
+     *  `model_uri_sub_resolver::supports_concurrent_lookups()`) are made
+     *  one at a time, while lookups handled by other sub-resolvers still
+     *  run concurrently.  This
+     *  allows, e.g., multiple FMUs to be unpacked in parallel.  Each distinct
+     *  reference is only looked up once.  Threads which are not needed for
+     *  concurrent lookups are left to the individual lookups, e.g. for
+     *  unpacking each FMU in parallel.
+     *
+     *  \returns
+     *      The models referred to by `modelUriReferences`, in the same order.
+     *
+     *  \throws
+     *      The first exception, in the order of `modelUriReferences`, thrown
+     *      by any of the lookups.  All lookups are complete when this
+     *      function returns or throws.
+     */
+    std::vector<std::shared_ptr<model>> lookup_models(
+        const uri& baseUri,
+        const std::vector<uri>& modelUriReferences,
+        unsigned int maxThreads = std::thread::hardware_concurrency());
+
 private:
+    std::shared_ptr<model> lookup_model(
+        const uri& baseUri,
+        const uri& modelUriReference,
+        unsigned int maxThreads,
+        std::vector<std::mutex>* subResolverMutexes);
+
     std::vector<std::shared_ptr<model_uri_sub_resolver>> subResolvers_;
 };
 
@@ -176,9 +234,20 @@ public:
 
     explicit fmu_file_uri_sub_resolver(std::shared_ptr<file_cache> cache);
 
+    using model_uri_sub_resolver::lookup_model;
+
     std::shared_ptr<model> lookup_model(const uri& modelUri) override;
 
+    std::shared_ptr<model> lookup_model(
+        const uri& baseUri,
+        const uri& modelUriReference,
+        unsigned int maxThreads) override;
+
+    bool supports_concurrent_lookups() const noexcept override { return true; }
+
 private:
+    std::shared_ptr<model> import_fmu(const uri& modelUri, unsigned int maxThreads);
+
     std::shared_ptr<fmi::importer> importer_;
 };
 
@@ -14,6 +14,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <istream>
 #include <ostream>
 #include <string>
 #include <variant>
@@ -103,12 +104,37 @@ namespace format
 const auto format_xalloc = std::ios_base::xalloc();
 const int FORMAT_CBOR = 1;
 const int FORMAT_PRETTY_PRINT = 2;
+const int FORMAT_BINARY = 3;
 
 std::ios_base& cbor(std::ios_base& os);
 std::ios_base& pretty_print(std::ios_base& os);
+std::ios_base& binary(std::ios_base& os);
 
 } // namespace format
 
+
+/**
+ *  Writes `data` to the output stream `out` in a compact binary format.
+ *
+ *  The data are streamed directly from the tree, with a one-byte type tag
+ *  per node, values in their native representation and byte order, and
+ *  strings and byte arrays prefixed by their length.  The format is meant
+ *  for fast round trips on the same platform, e.g. for checkpointing, and
+ *  not for exchanging data between platforms.  Use CBOR for that.
+ *
+ *  This is equivalent to `out << format::binary << data`, except that it
+ *  does not change the format of the stream.
+ */
+void write_binary(std::ostream& out, const node& data);
+
+/**
+ *  Reads data written with `write_binary()` from the input stream `in`.
+ *
+ *  \throws cosim::error
+ *      With code `errc::bad_file` if the data are invalid or truncated.
+ */
+node read_binary(std::istream& in);
+
 } // namespace serialization
 } // namespace cosim
 
@@ -0,0 +1,234 @@
+/**
+ *  \file
+ *  Timing metrics for simulation steps.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_STEP_METRICS_HPP
+#define COSIM_STEP_METRICS_HPP
+
+#include <cosim/time.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace cosim
+{
+
+/**
+ *  A histogram of the wall-clock durations of recent occurrences of some
+ *  operation.
+ *
+ *  The histogram covers a rolling window of the most recent samples, whose
+ *  size varies between half the window size and the full window size.
+ *  The buckets are logarithmic: bucket 0 counts durations shorter than
+ *  1 µs, bucket `i` counts durations in the range [2^(i-1), 2^i) µs, and
+ *  the last bucket also counts everything longer than that.
+ *
+ *  Recording a sample is lock-free, and should be done by one thread at a
+ *  time.  Reading may be done concurrently from any thread, but a snapshot
+ *  taken while samples are being recorded is not guaranteed to be
+ *  internally consistent.
+ */
+class duration_histogram
+{
+public:
+    /// The number of buckets.
+    static constexpr std::size_t bucket_count = 24;
+
+    /// The default window size.
+    static constexpr std::size_t default_window_size = 1000;
+
+    /// A snapshot of the samples in the rolling window.
+    struct snapshot
+    {
+        /// The number of samples in each bucket.
+        std::array<std::uint64_t, bucket_count> counts = {};
+
+        /// The number of samples.
+        std::uint64_t count = 0;
+
+        /// The sum of the sample durations.
+        duration total = duration::zero();
+
+        /// Returns the mean duration, or zero if there are no samples.
+        duration mean() const noexcept;
+
+        /**
+         *  Returns an upper bound on the `p`-quantile of the durations,
+         *  where `p` is in the range [0, 1], namely the upper bound of the
+         *  bucket which contains it.
+         */
+        duration percentile(double p) const noexcept;
+    };
+
+    /**
+     *  Constructor.
+     *
+     *  \param windowSize
+     *      The (maximum) number of samples in the rolling window.
+     */
+    explicit duration_histogram(std::size_t windowSize = default_window_size);
+
+    duration_histogram(const duration_histogram&) = delete;
+    duration_histogram& operator=(const duration_histogram&) = delete;
+    duration_histogram(duration_histogram&&) = delete;
+    duration_histogram& operator=(duration_histogram&&) = delete;
+
+    /// Records a sample.
+    void record(duration d) noexcept;
+
+    /// Returns a snapshot of the samples in the rolling window.
+    snapshot read() const noexcept;
+
+    /// Returns the total number of samples recorded.
+    std::uint64_t total_count() const noexcept;
+
+    /// Returns the sum of the durations of all samples recorded.
+    duration total_duration() const noexcept;
+
+    /// Returns the most recently recorded duration.
+    duration last() const noexcept;
+
+    /**
+     *  Returns the upper bound of bucket number `i`, or `duration::max()`
+     *  for the last bucket.
+     */
+    static duration bucket_upper_bound(std::size_t i) noexcept;
+
+private:
+    // The window is made up of two generations.  Samples are recorded in
+    // the current one, and when it is full, the other one is cleared and
+    // becomes the current one.
+    struct generation
+    {
+        std::array<std::atomic<std::uint64_t>, bucket_count> counts;
+        std::atomic<std::uint64_t> count;
+        std::atomic<duration::rep> total;
+    };
+
+    const std::uint64_t generationSize_;
+    std::array<generation, 2> generations_;
+    std::atomic<unsigned int> current_;
+    std::atomic<std::uint64_t> totalCount_;
+    std::atomic<duration::rep> totalDuration_;
+    std::atomic<duration::rep> last_;
+};
+
+
+/// Step timing metrics for one simulator.
+struct simulator_step_metrics
+{
+    /// Time spent setting input variables before each step.
+    duration_histogram set_variables;
+
+    /// Time spent in the subsimulator's time step function.
+    duration_histogram do_step;
+
+    /// Time spent getting output variables after each step.
+    duration_histogram get_variables;
+};
+
+
+/**
+ *  Step timing metrics for an execution.
+ *
+ *  This breaks down the wall-clock time of each step, both per simulator
+ *  and per phase of the step, in order to identify which simulators or
+ *  operations limit the speed of the simulation.
+ *
+ *  Metrics collection is disabled by default, and may be enabled with
+ *  `execution::enable_step_metrics()`.  All metrics may be read from any
+ *  thread while the simulation is running.
+ */
+class step_metrics
+{
+public:
+    step_metrics() = default;
+
+    step_metrics(const step_metrics&) = delete;
+    step_metrics& operator=(const step_metrics&) = delete;
+    step_metrics(step_metrics&&) = delete;
+    step_metrics& operator=(step_metrics&&) = delete;
+
+    /// Returns whether metrics collection is enabled.
+    bool enabled() const noexcept
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// Enables or disables metrics collection.
+    void set_enabled(bool enable) noexcept
+    {
+        enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    /**
+     *  Time spent in the algorithm's step function, which includes the
+     *  stepping of all simulators, transfers and function calculations.
+     */
+    duration_histogram step;
+
+    /**
+     *  Time spent in function calculations, including the transfers of
+     *  values to the functions.
+     *
+     *  When transfers are pipelined with simulator steps, this is the
+     *  total time spent on this work by all threads during the step, which
+     *  overlaps with the time spent stepping the simulators.
+     */
+    duration_histogram functions;
+
+    /**
+     *  Time spent transferring values to simulators.
+     *
+     *  When transfers are pipelined with simulator steps, this is the
+     *  total time spent on this work by all threads during the step, which
+     *  overlaps with the time spent stepping the simulators.
+     */
+    duration_histogram transfers;
+
+    /// Time spent notifying observers after each step.
+    duration_histogram observers;
+
+    /// Time spent notifying manipulators before each step.
+    duration_histogram manipulators;
+
+    /// Returns the number of simulators for which there are metrics.
+    std::size_t simulator_count() const noexcept
+    {
+        return simulators_.size();
+    }
+
+    /**
+     *  Returns the metrics for the simulator with the given index.
+     *
+     *  \pre `index < simulator_count()`
+     */
+    const simulator_step_metrics& simulator(std::size_t index) const;
+
+    /**
+     *  Adds metrics for the next simulator, and returns them.
+     *
+     *  This must not be called concurrently with any other member
+     *  function.  Since simulators are added to an execution before it is
+     *  initialized, this is normally not a problem.
+     */
+    simulator_step_metrics& add_simulator();
+
+private:
+    std::atomic<bool> enabled_ = false;
+    std::vector<std::unique_ptr<simulator_step_metrics>> simulators_;
+};
+
+
+} // namespace cosim
+#endif // COSIM_STEP_METRICS_HPP
@@ -5,17 +5,24 @@
  */
 #include "cosim/algorithm/ecco_algorithm.hpp"
 
+#include "cosim/algorithm/transfer_plan.hpp"
+#include "cosim/algorithm/worker_pool.hpp"
 #include "cosim/error.hpp"
 #include "cosim/exception.hpp"
 #include "cosim/log/logger.hpp"
 #include "cosim/time.hpp"
-#include "cosim/utility/thread_pool.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
-#include <iostream>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -23,19 +30,193 @@
 namespace cosim
 {
 
+namespace
+{
+// Accumulates the energy transferred through one side of a power bond, in
+// constant memory.  The running sum and mean cover all steps, while the
+// per-step energies are only retained for the most recent steps, in a ring
+// buffer.
+class energy_accumulator
+{
+public:
+    void add(double energy)
+    {
+        ++count_;
+        total_ += energy;
+        mean_ += (energy - mean_) / static_cast<double>(count_);
+        if (windowSize_ == 0) return;
+        if (window_.size() < windowSize_) {
+            window_.push_back(energy);
+        } else {
+            windowTotal_ -= window_[next_];
+            window_[next_] = energy;
+        }
+        windowTotal_ += energy;
+        next_ = (next_ + 1) % windowSize_;
+        // Recompute the window total once per cycle, so rounding errors
+        // from the running updates don't accumulate.
+        if (next_ == 0) {
+            windowTotal_ = std::accumulate(window_.begin(), window_.end(), 0.0);
+        }
+    }
+
+    void set_window_size(std::size_t size)
+    {
+        auto retained = window();
+        if (retained.size() > size) {
+            retained.erase(retained.begin(), retained.end() - size);
+        }
+        windowSize_ = size;
+        window_ = std::move(retained);
+        window_.reserve(size);
+        next_ = (size == 0) ? 0 : window_.size() % size;
+        windowTotal_ = std::accumulate(window_.begin(), window_.end(), 0.0);
+    }
+
+    // Returns the retained per-step energies, oldest first.
+    std::vector<double> window() const
+    {
+        if (window_.size() < windowSize_) return window_;
+        auto ordered = std::vector<double>(window_.begin() + next_, window_.end());
+        ordered.insert(ordered.end(), window_.begin(), window_.begin() + next_);
+        return ordered;
+    }
+
+    powerbond_energy_stats stats() const
+    {
+        powerbond_energy_stats s;
+        s.step_count = count_;
+        s.total = total_;
+        s.mean = mean_;
+        if (!window_.empty()) {
+            s.window_mean = windowTotal_ / static_cast<double>(window_.size());
+        }
+        return s;
+    }
+
+    serialization::node export_state() const
+    {
+        serialization::node exportedState;
+        exportedState.put("step_count", count_);
+        exportedState.put("total", total_);
+        exportedState.put("mean", mean_);
+        serialization::node exportedWindow;
+        const auto energies = window();
+        for (std::size_t i = 0; i < energies.size(); ++i) {
+            exportedWindow.put(std::to_string(i), energies[i]);
+        }
+        exportedState.put_child("window", exportedWindow);
+        return exportedState;
+    }
+
+    // The window size is kept, and the imported window is truncated to it
+    // if necessary.
+    void import_state(const serialization::node& exportedState)
+    {
+        count_ = exportedState.get<std::int64_t>("step_count");
+        total_ = exportedState.get<double>("total");
+        mean_ = exportedState.get<double>("mean");
+        const auto& exportedWindow = exportedState.get_child("window");
+        std::vector<double> energies(exportedWindow.size());
+        for (const auto& [key, child] : exportedWindow) {
+            energies.at(std::stoul(key)) = child.get_value<double>();
+        }
+        const auto windowSize = windowSize_;
+        windowSize_ = energies.size();
+        window_ = std::move(energies);
+        next_ = 0;
+        set_window_size(windowSize);
+    }
+
+private:
+    std::int64_t count_ = 0;
+    double total_ = 0.0;
+    double mean_ = 0.0;
+
+    std::size_t windowSize_ = 0;
+    std::vector<double> window_;
+    std::size_t next_ = 0; // The position of the oldest energy when full
+    double windowTotal_ = 0.0;
+};
+
+
+// The variable values and powers of all power bonds in one step, in
+// structure-of-arrays form, so the error estimate can be computed with
+// simple loops over contiguous arrays which the compiler can vectorise.
+struct power_bond_values
+{
+    std::vector<double> inputA;
+    std::vector<double> outputA;
+    std::vector<double> inputB;
+    std::vector<double> outputB;
+    std::vector<double> powerA;
+    std::vector<double> powerB;
+    std::vector<double> residual;
+
+    void resize(std::size_t bondCount)
+    {
+        for (auto v : {&inputA, &outputA, &inputB, &outputB, &powerA, &powerB, &residual}) {
+            v->resize(bondCount);
+        }
+    }
+
+    std::size_t size() const noexcept { return residual.size(); }
+
+    // Computes the powers and power residuals from the gathered variable
+    // values, and returns the RMS of the energy residuals in a step of
+    // length `dt`, normalised by the tolerance.
+    double error_estimate(double dt, double absTolerance, double relTolerance)
+    {
+        const auto n = size();
+        if (n == 0) return 0.0;
+
+        const double* ia = inputA.data();
+        const double* oa = outputA.data();
+        const double* ib = inputB.data();
+        const double* ob = outputB.data();
+        double* pa = powerA.data();
+        double* pb = powerB.data();
+        double* r = residual.data();
+        // Separate loops keep the number of arrays per loop, and thus the
+        // run-time aliasing checks needed to vectorise it, small.
+        for (std::size_t k = 0; k < n; ++k) pa[k] = ia[k] * oa[k];
+        for (std::size_t k = 0; k < n; ++k) pb[k] = ib[k] * ob[k];
+        for (std::size_t k = 0; k < n; ++k) r[k] = std::abs(pa[k] - pb[k]);
+        const auto maxResidual = *std::max_element(r, r + n);
+
+        // Each energy residual, `r[k] * dt`, is divided by the same
+        // tolerance, which is based on the largest one.
+        const auto scale = dt / (absTolerance + relTolerance * maxResidual * dt);
+        double sumSquares = 0.0;
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto e = r[k] * scale;
+            sumSquares += e * e;
+        }
+        return std::sqrt(sumSquares / static_cast<double>(n)); // TODO: Still valid for multidimensial bonds?
+    }
+};
+} // namespace
+
+
 class ecco_algorithm::impl
 {
 public:
-    explicit impl(ecco_algorithm_params params, std::optional<unsigned int> workerThreadCount)
+    explicit impl(
+        ecco_algorithm_params params,
+        std::optional<unsigned int> workerThreadCount,
+        worker_pool_type workerPoolType)
         : params_(params)
         , stepSize_(params.step_size)
-        , pool_(std::min(workerThreadCount.value_or(max_threads_), max_threads_))
+        , workers_(std::min(workerThreadCount.value_or(max_threads_), max_threads_), workerPoolType)
     {
         COSIM_INPUT_CHECK(params_.min_step_size.count() > 0);
         COSIM_INPUT_CHECK(params_.step_size >= params_.min_step_size);
         COSIM_INPUT_CHECK(params_.step_size <= params_.max_step_size);
     }
 
+    // The states saved for rollback are not released here, since the
+    // simulators may already have been destroyed.  If not, they are released
+    // along with the simulators.
     ~impl() noexcept = default;
 
     impl(const impl&) = delete;
@@ -47,43 +228,60 @@ public:
     void add_simulator(simulator_index i, simulator* s, [[maybe_unused]] duration stepSizeHint)
     {
         assert(simulators_.count(i) == 0);
-        simulators_[i].sim = s;
+        auto& info = simulators_[i];
+        info.sim = s;
+        simulatorList_.push_back(&info);
+        transferPlanValid_ = false;
+        powerBondsValid_ = false;
+        rollbackSupported_.reset();
     }
 
     void remove_simulator(simulator_index i)
     {
-        simulators_.erase(i);
+        if (const auto it = simulators_.find(i); it != simulators_.end()) {
+            release_rollback_state(it->second);
+            simulatorList_.erase(
+                std::find(simulatorList_.begin(), simulatorList_.end(), &it->second));
+            simulators_.erase(it);
+        }
         disconnect_simulator_variables(i);
+        transferPlanValid_ = false;
+        powerBondsValid_ = false;
+        rollbackSupported_.reset();
     }
 
     void add_function(function_index i, function* f)
     {
         assert(functions_.count(i) == 0);
         functions_[i].fun = f;
+        transferPlanValid_ = false;
     }
 
     void connect_variables(variable_id output, variable_id input)
     {
         auto& sourceSimInfo = simulators_.at(output.simulator);
         auto& targetSimInfo = simulators_.at(input.simulator);
-        sourceSimInfo.sim->expose_for_getting(output.type, output.reference);
-        targetSimInfo.sim->expose_for_setting(input.type, input.reference);
-        sourceSimInfo.outgoingSimConnections.push_back({output, input});
+        const auto sourceSlot = sourceSimInfo.sim->expose_for_getting(output.type, output.reference);
+        const auto targetSlot = targetSimInfo.sim->expose_for_setting(input.type, input.reference);
+        sourceSimInfo.outgoingSimConnections.push_back({output, input, sourceSlot, targetSlot});
+        transferPlanValid_ = false;
     }
 
     void connect_variables(variable_id output, function_io_id input)
     {
         auto& simInfo = simulators_.at(output.simulator);
-        simInfo.sim->expose_for_getting(output.type, output.reference);
-        simInfo.outgoingFunConnections.push_back({output, input});
+        const auto sourceSlot = simInfo.sim->expose_for_getting(output.type, output.reference);
+        simInfo.outgoingFunConnections.push_back({output, input, sourceSlot});
+        transferPlanValid_ = false;
     }
 
     void connect_variables(function_io_id output, variable_id input)
     {
         auto& funInfo = functions_.at(output.function);
         auto& simInfo = simulators_.at(input.simulator);
-        simInfo.sim->expose_for_setting(input.type, input.reference);
-        funInfo.outgoingSimConnections.push_back({output, input});
+        const auto targetSlot = simInfo.sim->expose_for_setting(input.type, input.reference);
+        funInfo.outgoingSimConnections.push_back({output, input, targetSlot});
+        transferPlanValid_ = false;
     }
 
     void disconnect_variable(variable_id input)
@@ -96,6 +294,7 @@ public:
                 [input](const auto& c) { return c.target == input; });
             if (it != conns.end()) {
                 conns.erase(it);
+                transferPlanValid_ = false;
                 // There can be only one connection to an input variable,
                 // so we return as early as possible.
                 return;
@@ -113,6 +312,7 @@ public:
                 [input](const auto& c) { return c.target == input; });
             if (it != conns.end()) {
                 conns.erase(it);
+                transferPlanValid_ = false;
                 // There can be only one connection to an input variable,
                 // so we return as early as possible.
                 return;
@@ -128,170 +328,167 @@ public:
 
     void initialize()
     {
-        for (auto& s : simulators_) {
-            pool_.submit([&] {
-                s.second.sim->setup(startTime_, stopTime_, std::nullopt);
-            });
-        }
-        pool_.wait_for_tasks_to_finish();
-
-        // Run N iterations of the simulators' and functions' step/calculation
-        // procedures, where N is the number of simulators in the system,
-        // to propagate initial values.
-        for (std::size_t i = 0; i < simulators_.size() + functions_.size(); ++i) {
-            for (auto& s : simulators_) {
-                pool_.submit([&] {
-                    s.second.sim->do_iteration();
-                });
-            }
-            pool_.wait_for_tasks_to_finish();
-
-            for (const auto& s : simulators_) {
-                transfer_variables(s.second.outgoingSimConnections);
-                transfer_variables(s.second.outgoingFunConnections);
-            }
-            for (const auto& f : functions_) {
-                f.second.fun->calculate();
-                transfer_variables(f.second.outgoingSimConnections);
-            }
-        }
-
-        for (auto& s : simulators_) {
-            pool_.submit([&] {
-                s.second.sim->start_simulation();
-            });
-        }
-        pool_.wait_for_tasks_to_finish();
+        workers_.for_each(simulatorList_, [&](simulator_info& info) {
+            info.sim->setup(startTime_, stopTime_, std::nullopt);
+        });
+
+        // Evaluate every simulator once, so the values set during setup
+        // are applied and reflected in the outputs.  Then propagate initial
+        // values through the system in dependency order, iterating only on
+        // algebraic loops, and finally perform all transfers once more so
+        // the final outputs reach their targets.
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            info.sim->do_iteration();
+        });
+        if (!transferPlanValid_) compile_transfer_plan();
+        std::vector<simulator*> simulators;
+        simulators.reserve(simulatorList_.size());
+        for (const auto info : simulatorList_) simulators.push_back(info->sim);
+        transferPlan_.propagate_initial_values(
+            simulators,
+            std::max<std::size_t>(simulators_.size() + functions_.size(), 1),
+            [this](std::size_t count, const auto& task) { workers_.parallel_for(count, task); });
+        calculate_and_transfer();
+
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            info.sim->start_simulation();
+        });
     }
 
     std::pair<duration, std::unordered_set<simulator_index>> do_step(time_point currentT)
     {
-        std::mutex m;
-        bool failed = false;
-        std::stringstream errMessages;
-        std::unordered_set<simulator_index> finished;
-        // Initiate simulator time steps.
-
-        for (auto& s : simulators_) {
-            auto& info = s.second;
-            pool_.submit([&] {
-                try {
-                    info.stepResult = info.sim->do_step(currentT, stepSize_);
-
-                    if (info.stepResult != step_result::complete) {
-                        std::lock_guard<std::mutex> lck(m);
-                        errMessages
-                            << info.sim->name() << ": "
-                            << "Step not complete" << '\n';
-                        failed = true;
-                    }
-
-                } catch (std::exception& ex) {
-                    std::lock_guard<std::mutex> lck(m);
-                    errMessages
-                        << info.sim->name() << ": "
-                        << ex.what() << '\n';
-                    failed = true;
+        // In rollback mode, the transfers can't start before the step has
+        // been accepted, so pipelining is disabled.  Simulator states can't
+        // be saved while variable modifiers are active, so such steps are
+        // always accepted.
+        const bool rollback = stepRejection_ && stepCounter_ >= 1 &&
+            can_roll_back() && !modifiers_active();
+        const bool pipelined = pipelinedStepping_ && !rollback;
+        if (rollback) save_simulator_states();
+
+        auto stepSizeTaken = stepSize_;
+        for (;;) {
+            // In pipelined mode, the transfers for the next step are performed
+            // as soon as their dependencies are done stepping.
+            if (pipelined) start_transfer_pipeline(stepCounter_ + 1);
+            step_simulators(currentT, pipelined);
+            stepSizeTaken = stepSize_;
+
+            // The step size is adjusted from the second step onwards.  If the
+            // error estimate exceeds the tolerance, and we can roll back, the
+            // step is rejected and retried with a smaller step size.
+            if (stepCounter_ < 1) break;
+            const auto errorEstimate = estimate_error(to_double_duration(stepSize_, currentT));
+            if (rollback && errorEstimate > 1.0) {
+                const auto reducedStepSize = rejected_step_size(currentT, stepSize_, errorEstimate);
+                if (reducedStepSize < stepSize_) {
+                    BOOST_LOG_SEV(log::logger(), log::debug)
+                        << "Rejecting step of " << to_double_duration(stepSize_, currentT)
+                        << " s at t = " << to_double_time_point(currentT)
+                        << " s (error estimate " << errorEstimate << "), retrying with "
+                        << to_double_duration(reducedStepSize, currentT) << " s";
+                    restore_simulator_states();
+                    stepSize_ = reducedStepSize;
+                    ++rejectedStepCount_;
+                    continue;
                 }
-            });
+            }
+            accumulate_energies(to_double_duration(stepSize_, currentT));
+            stepSize_ = adjust_step_size(currentT, stepSize_, errorEstimate);
+            break;
         }
-
         ++stepCounter_;
 
-        for (auto& [idx, info] : simulators_) {
-            finished.insert(idx);
-        }
-
-        pool_.wait_for_tasks_to_finish();
-
-        if (failed) {
-            throw error(make_error_code(errc::simulation_error), errMessages.str());
-        }
-
-        const auto stepSizeTaken = stepSize_;
-        if (stepCounter_ >= 2) {
-            stepSize_ = adjust_step_size(currentT, stepSize_, params_);
-        }
-
-        // Transfer the outputs from simulators that have finished their
-        // individual time steps within this co-simulation time step.
-        for (auto simIndex : finished) {
-            auto& simInfo = simulators_.at(simIndex);
-            transfer_variables(simInfo.outgoingSimConnections);
-            transfer_variables(simInfo.outgoingFunConnections);
-        }
-
-        // Calculate functions and transfer their outputs to simulators.
-        for (const auto& f : functions_) {
-            const auto& info = f.second;
-            info.fun->calculate();
-            transfer_variables(info.outgoingSimConnections);
+        // Transfer simulator outputs, calculate functions and transfer
+        // their outputs to simulators.  (All simulators finish their time
+        // steps in every co-simulation time step.)
+        if (pipelined) {
+            transferPlan_.record_pipeline_time(stepMetrics_.get());
+        } else {
+            calculate_and_transfer();
         }
 
-
-        return {stepSizeTaken, std::move(finished)};
+        return {stepSizeTaken, all_simulators()};
     }
 
     serialization::node export_current_state() const
     {
-        throw error(make_error_code(errc::unsupported_feature), "State saving not yet supported by the ECCO algorithm!");
+        auto exportedState = serialization::node();
+        exportedState.put("type", std::string("ecco_algorithm"));
+        exportedState.put("step_counter", stepCounter_);
+        exportedState.put<std::int64_t>("step_size_ticks", stepSize_.count());
+        exportedState.put("prev_error_estimate", prev_error_estimate_);
+        serialization::node exportedEnergies;
+        for (std::size_t i = 0; i < energies_.size(); ++i) {
+            exportedEnergies.put_child(std::to_string(i), energies_[i].export_state());
+        }
+        exportedState.put_child("energies", exportedEnergies);
+        return exportedState;
     }
 
-    void import_state([[maybe_unused]] const serialization::node& exportedState)
+    // The power bonds must be the same as when the state was exported.
+    void import_state(const serialization::node& exportedState)
     {
-        throw error(make_error_code(errc::unsupported_feature), "State saving not yet supported by the ECCO algorithm!");
+        try {
+            if (exportedState.get<std::string>("type") != "ecco_algorithm") {
+                throw std::exception();
+            }
+            const auto& exportedEnergies = exportedState.get_child("energies");
+            if (exportedEnergies.size() != energies_.size()) {
+                throw std::exception();
+            }
+            auto energies = energies_;
+            for (std::size_t i = 0; i < energies.size(); ++i) {
+                energies[i].import_state(exportedEnergies.get_child(std::to_string(i)));
+            }
+            const auto stepCounter = exportedState.get<std::int64_t>("step_counter");
+            const auto stepSize = duration(exportedState.get<std::int64_t>("step_size_ticks"));
+            const auto prevErrorEstimate = exportedState.get<double>("prev_error_estimate");
+            stepCounter_ = stepCounter;
+            stepSize_ = stepSize;
+            prev_error_estimate_ = prevErrorEstimate;
+            energies_ = std::move(energies);
+        } catch (...) {
+            throw error(
+                make_error_code(errc::bad_file),
+                "The serialized algorithm state is invalid or corrupt");
+        }
     }
 
-    void get_energies()
+    // Gathers the power bond variable values, computes the power residual
+    // of each power bond, and returns the normalised error estimate, where 1
+    // corresponds to the tolerance.  The energies are not accumulated until
+    // `accumulate_energies()` is called, so a rejected step leaves no trace.
+    double estimate_error(double dt)
     {
-        for (std::size_t i = 0; i < energies_.size(); ++i) {
-            std::cout << "Avg energy for sim idx " << i << ": " << get_mean(energies_.at(i)) << std::endl;
+        if (!powerBondsValid_) compile_power_bonds();
+        for (std::size_t k = 0; k < bondValues_.size(); ++k) {
+            const auto* e = &bondEndpoints_[4 * k];
+            bondValues_.inputA[k] = e[0].sim->get_real(e[0].slot);
+            bondValues_.outputA[k] = e[1].sim->get_real(e[1].slot);
+            bondValues_.inputB[k] = e[2].sim->get_real(e[2].slot);
+            bondValues_.outputB[k] = e[3].sim->get_real(e[3].slot);
         }
+        return bondValues_.error_estimate(dt, params_.abs_tolerance, params_.rel_tolerance);
     }
 
-    duration adjust_step_size(time_point currentTime, const duration& stepSize, const ecco_algorithm_params& params)
+    // Adds the energies transferred in a step of length `dt`, as computed
+    // by the last call to `estimate_error()`.
+    void accumulate_energies(double dt)
     {
-        std::vector<double> power_residuals{};
-        std::vector<double> power{};
-
-        const auto dt = to_double_duration(stepSize, currentTime);
-
-        for (std::size_t i = 0; i < inputVariables_.size(); i += 2) {
-            auto input_a = inputVariables_.at(i);
-            auto input_b = inputVariables_.at(i + 1);
-            auto output_a = outputVariables_.at(i);
-            auto output_b = outputVariables_.at(i + 1);
-
-            double input_a_value = simulators_.at(input_a.simulator).sim->get_real(input_a.reference);
-            double input_b_value = simulators_.at(input_b.simulator).sim->get_real(input_b.reference);
-            double output_a_value = simulators_.at(output_a.simulator).sim->get_real(output_a.reference);
-            double output_b_value = simulators_.at(output_b.simulator).sim->get_real(output_b.reference);
-
-            double power_a = input_a_value * output_a_value;
-            energies_.at(i).push_back(power_a * dt);
-
-            double power_b = input_b_value * output_b_value;
-            energies_.at(i + 1).push_back(power_b * dt);
-
-            double power_residual = std::abs(power_a - power_b);
-
-            power_residuals.push_back(power_residual);
+        for (std::size_t k = 0; k < bondValues_.size(); ++k) {
+            energies_[2 * k].add(bondValues_.powerA[k] * dt);
+            energies_[2 * k + 1].add(bondValues_.powerB[k] * dt);
         }
+    }
 
-        if (power_residuals.empty()) {
+    duration adjust_step_size(time_point currentTime, const duration& stepSize, double error_estimate)
+    {
+        const auto& params = params_;
+        if (bondValues_.size() == 0) {
             return stepSize;
         }
 
-        double max_power_residual = *std::max_element(power_residuals.begin(), power_residuals.end());
-        const auto energy_level = max_power_residual * dt;
-        double mean_square{};
-        for (auto power_residual : power_residuals) {
-            const auto energy_residual = power_residual * dt;
-            mean_square += std::pow(energy_residual / (params.abs_tolerance + params.rel_tolerance * energy_level), 2);
-        }
-        const auto num_bonds = power_residuals.size(); // TODO: Still valid for multidimensial bonds?
-        const auto error_estimate = std::sqrt(mean_square / (double)num_bonds);
-
         if (prev_error_estimate_ == 0 || error_estimate == 0) {
             prev_error_estimate_ = error_estimate;
             return stepSize;
@@ -307,58 +504,121 @@ public:
         return actual_new_step_size;
     }
 
+    // Returns the step size with which to retry a rejected step.  Only the
+    // integral part of the controller is used, since the rejected error
+    // estimate should not become the "previous" one.
+    duration rejected_step_size(time_point currentTime, const duration& stepSize, double error_estimate) const
+    {
+        const auto gain = std::clamp(
+            params_.safety_factor * std::pow(error_estimate, -params_.i_gain),
+            params_.min_change_rate,
+            1.0);
+        const auto new_step_size = to_duration(gain * to_double_duration(stepSize, currentTime));
+        return std::clamp(new_step_size, params_.min_step_size, params_.max_step_size);
+    }
+
     void add_power_bond(cosim::variable_id input_a, cosim::variable_id output_a, cosim::variable_id input_b, cosim::variable_id output_b)
     {
-        energies_.emplace_back();
-        energies_.emplace_back();
-        inputVariables_.push_back(input_a);
-        outputVariables_.push_back(output_a);
-        inputVariables_.push_back(input_b);
-        outputVariables_.push_back(output_b);
+        // The bond's inputs must be exposed for getting too, since we read
+        // them to compute the power.
+        for (const auto& v : {input_a, output_a, input_b, output_b}) {
+            simulators_.at(v.simulator).sim->expose_for_getting(v.type, v.reference);
+        }
+        for (int side = 0; side < 2; ++side) {
+            energies_.emplace_back();
+            energies_.back().set_window_size(energyWindowSize_);
+        }
+        bondVariables_.insert(bondVariables_.end(), {input_a, output_a, input_b, output_b});
+        powerBondsValid_ = false;
     }
 
-    std::vector<double> get_powerbond_energies(cosim::simulator_index simulator_index)
+    void set_energy_window_size(std::size_t size)
     {
-        return energies_.at(simulator_index);
+        energyWindowSize_ = size;
+        for (auto& e : energies_) e.set_window_size(size);
     }
 
-private:
-    std::vector<cosim::variable_id> inputVariables_{};
-    std::vector<cosim::variable_id> outputVariables_{};
-    std::vector<std::vector<double>> energies_{};
+    std::vector<double> get_powerbond_energies(std::size_t index) const
+    {
+        return energies_.at(index).window();
+    }
 
-    double get_mean(const std::vector<double>& elems)
+    powerbond_energy_stats get_powerbond_energy_stats(std::size_t index) const
     {
-        if (elems.empty()) return 0.0;
-        double sum{};
-        for (auto elem : elems) {
-            sum += elem;
+        return energies_.at(index).stats();
+    }
+
+    void set_step_rejection(bool enable)
+    {
+        stepRejection_ = enable;
+        if (!enable) {
+            for (auto info : simulatorList_) release_rollback_state(*info);
         }
-        return sum / (double)elems.size();
     }
 
+    std::int64_t get_rejected_step_count() const
+    {
+        return rejectedStepCount_;
+    }
+
+    void set_parallel_transfers(bool enable)
+    {
+        parallelTransfers_ = enable;
+    }
+
+    void set_pipelined_stepping(bool enable)
+    {
+        pipelinedStepping_ = enable;
+    }
+
+    void set_step_metrics(std::shared_ptr<step_metrics> metrics)
+    {
+        stepMetrics_ = std::move(metrics);
+    }
+
+private:
+    // The variables of each power bond, in the order `input_a, output_a,
+    // input_b, output_b`, and the simulators and slots they resolve to.
+    struct bond_endpoint
+    {
+        simulator* sim;
+        variable_slot slot;
+    };
+    std::vector<cosim::variable_id> bondVariables_{};
+    std::vector<bond_endpoint> bondEndpoints_{};
+    bool powerBondsValid_ = false;
+    power_bond_values bondValues_{};
+    std::vector<energy_accumulator> energies_{};
+    std::size_t energyWindowSize_ = 0;
+
+
     struct connection_ss
     {
         variable_id source;
         variable_id target;
+        variable_slot sourceSlot;
+        variable_slot targetSlot;
     };
 
     struct connection_sf
     {
         variable_id source;
         function_io_id target;
+        variable_slot sourceSlot;
     };
 
     struct connection_fs
     {
         function_io_id source;
         variable_id target;
+        variable_slot targetSlot;
     };
 
     struct simulator_info
     {
         simulator* sim;
         step_result stepResult;
+        std::optional<simulator::state_index> rollbackState;
         std::vector<connection_ss> outgoingSimConnections;
         std::vector<connection_sf> outgoingFunConnections;
     };
@@ -369,6 +629,142 @@ private:
         std::vector<connection_fs> outgoingSimConnections;
     };
 
+    // Performs a time step for every simulator, and throws if any of them
+    // fail.
+    void step_simulators(time_point currentT, bool pipelined)
+    {
+        std::mutex m;
+        bool failed = false;
+        std::stringstream errMessages;
+
+        // Perform simulator time steps, and wait for all of them to finish.
+        workers_.for_each(simulatorList_, [&](simulator_info& info) {
+            try {
+                info.stepResult = info.sim->do_step(currentT, stepSize_);
+
+                if (info.stepResult != step_result::complete) {
+                    std::lock_guard<std::mutex> lck(m);
+                    errMessages
+                        << info.sim->name() << ": "
+                        << "Step not complete" << '\n';
+                    failed = true;
+                }
+
+            } catch (std::exception& ex) {
+                std::lock_guard<std::mutex> lck(m);
+                errMessages
+                    << info.sim->name() << ": "
+                    << ex.what() << '\n';
+                failed = true;
+            }
+            if (pipelined) {
+                // Failed transfers and function calculations are reported
+                // along with the failed time steps.
+                try {
+                    transferPlan_.simulator_done(info.sim);
+                } catch (std::exception& ex) {
+                    std::lock_guard<std::mutex> lck(m);
+                    errMessages
+                        << info.sim->name() << ": "
+                        << ex.what() << '\n';
+                    failed = true;
+                }
+            }
+        });
+
+        if (failed) {
+            ++stepCounter_;
+            throw error(make_error_code(errc::simulation_error), errMessages.str());
+        }
+    }
+
+    std::unordered_set<simulator_index> all_simulators() const
+    {
+        std::unordered_set<simulator_index> indices;
+        for (const auto& entry : simulators_) indices.insert(entry.first);
+        return indices;
+    }
+
+    // Returns whether all simulators can save and restore their state, so
+    // that steps can be rolled back.
+    bool can_roll_back()
+    {
+        if (!rollbackSupported_) {
+            rollbackSupported_ = std::all_of(
+                simulatorList_.begin(),
+                simulatorList_.end(),
+                [](const simulator_info* info) {
+                    return info->sim->model_description()->capabilities.can_save_state;
+                });
+            if (!*rollbackSupported_) {
+                BOOST_LOG_SEV(log::logger(), log::warning)
+                    << "Step rejection is enabled, but not all simulators can save "
+                    << "their state.  Steps will be accepted regardless of their "
+                    << "error estimate.";
+            }
+        }
+        return *rollbackSupported_;
+    }
+
+    // Returns whether any simulator has an active variable modifier, which
+    // prevents it from saving and restoring its state.
+    bool modifiers_active() const
+    {
+        return std::any_of(
+            simulatorList_.begin(),
+            simulatorList_.end(),
+            [](const simulator_info* info) {
+                const auto sim = info->sim;
+                return !sim->get_modified_real_variables().empty() ||
+                    !sim->get_modified_integer_variables().empty() ||
+                    !sim->get_modified_boolean_variables().empty() ||
+                    !sim->get_modified_string_variables().empty();
+            });
+    }
+
+    void save_simulator_states()
+    {
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            if (info.rollbackState) {
+                info.sim->save_state(*info.rollbackState);
+            } else {
+                info.rollbackState = info.sim->save_state();
+            }
+        });
+    }
+
+    void restore_simulator_states()
+    {
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            info.sim->restore_state(*info.rollbackState);
+        });
+    }
+
+    static void release_rollback_state(simulator_info& info) noexcept
+    {
+        if (!info.rollbackState) return;
+        try {
+            info.sim->release_state(*info.rollbackState);
+        } catch (const std::exception& e) {
+            BOOST_LOG_SEV(log::logger(), log::warning)
+                << "Failed to release saved state of " << info.sim->name() << ": " << e.what();
+        }
+        info.rollbackState.reset();
+    }
+
+    // Resolves the power bond variables to simulators and slots, and sizes
+    // the arrays in `bondValues_` accordingly.
+    void compile_power_bonds()
+    {
+        bondEndpoints_.clear();
+        for (const auto& v : bondVariables_) {
+            const auto sim = simulators_.at(v.simulator).sim;
+            bondEndpoints_.push_back({sim, sim->expose_for_getting(v.type, v.reference)});
+        }
+        bondValues_.resize(bondVariables_.size() / 4);
+        powerBondsValid_ = true;
+    }
+
     void disconnect_simulator_variables(simulator_index i)
     {
         for (auto& s : simulators_) {
@@ -389,88 +785,32 @@ private:
         }
     }
 
-    void transfer_variables(const std::vector<connection_ss>& connections)
+    void start_transfer_pipeline(std::int64_t n)
     {
-        for (const auto& c : connections) {
-            transfer_variable(c);
-        }
+        if (!transferPlanValid_) compile_transfer_plan();
+        const auto metrics = stepMetrics_.get();
+        transferPlan_.start_pipeline(n, metrics && metrics->enabled());
     }
 
-    void transfer_variables(const std::vector<connection_sf>& connections)
+    void calculate_and_transfer()
     {
-        for (const auto& c : connections) {
-            transfer_variable(c);
-        }
+        if (!transferPlanValid_) compile_transfer_plan();
+        transferPlan_.execute(
+            stepCounter_,
+            parallelTransfers_ ? &workers_ : nullptr,
+            stepMetrics_.get());
     }
 
-    void transfer_variables(const std::vector<connection_fs>& connections)
+    // Compiles the connection graph into `transferPlan_`.  Since this
+    // algorithm doesn't use decimation, every transfer has a period of 1.
+    void compile_transfer_plan()
     {
-        for (const auto& c : connections) {
-            transfer_variable(c);
-        }
-    }
-
-    void transfer_variable(const connection_ss& c)
-    {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                simulators_.at(c.target.simulator).sim->set_real(c.target.reference, simulators_.at(c.source.simulator).sim->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                simulators_.at(c.target.simulator).sim->set_integer(c.target.reference, simulators_.at(c.source.simulator).sim->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                simulators_.at(c.target.simulator).sim->set_boolean(c.target.reference, simulators_.at(c.source.simulator).sim->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                simulators_.at(c.target.simulator).sim->set_string(c.target.reference, simulators_.at(c.source.simulator).sim->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
-    }
-
-    void transfer_variable(const connection_sf& c)
-    {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                functions_.at(c.target.function).fun->set_real(c.target.reference, simulators_.at(c.source.simulator).sim->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                functions_.at(c.target.function).fun->set_integer(c.target.reference, simulators_.at(c.source.simulator).sim->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                functions_.at(c.target.function).fun->set_boolean(c.target.reference, simulators_.at(c.source.simulator).sim->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                functions_.at(c.target.function).fun->set_string(c.target.reference, simulators_.at(c.source.simulator).sim->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
-    }
-
-    void transfer_variable(const connection_fs& c)
-    {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                simulators_.at(c.target.simulator).sim->set_real(c.target.reference, functions_.at(c.source.function).fun->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                simulators_.at(c.target.simulator).sim->set_integer(c.target.reference, functions_.at(c.source.function).fun->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                simulators_.at(c.target.simulator).sim->set_boolean(c.target.reference, functions_.at(c.source.function).fun->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                simulators_.at(c.target.simulator).sim->set_string(c.target.reference, functions_.at(c.source.function).fun->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
+        detail::compile_transfer_plan(
+            transferPlan_,
+            simulators_,
+            functions_,
+            [](const auto&) { return 1; });
+        transferPlanValid_ = true;
     }
 
     const ecco_algorithm_params params_;
@@ -479,15 +819,27 @@ private:
     std::optional<time_point> stopTime_;
     std::unordered_map<simulator_index, simulator_info> simulators_;
     std::unordered_map<function_index, function_info> functions_;
+    std::vector<simulator_info*> simulatorList_; // `simulators_` elements in order of addition
     int64_t stepCounter_ = 0;
     unsigned int max_threads_ = std::thread::hardware_concurrency() - 1;
-    utility::thread_pool pool_;
+    detail::worker_pool workers_;
+    detail::transfer_plan transferPlan_;
+    bool transferPlanValid_ = false;
+    bool parallelTransfers_ = false;
+    bool pipelinedStepping_ = false;
+    bool stepRejection_ = false;
+    std::optional<bool> rollbackSupported_; // Cached result of `can_roll_back()`
+    std::int64_t rejectedStepCount_ = 0;
+    std::shared_ptr<step_metrics> stepMetrics_;
     double prev_error_estimate_{1.0};
 };
 
 
-ecco_algorithm::ecco_algorithm(ecco_algorithm_params params, std::optional<unsigned int> workerThreadCount)
-    : pimpl_(std::make_unique<impl>(params, workerThreadCount))
+ecco_algorithm::ecco_algorithm(
+    ecco_algorithm_params params,
+    std::optional<unsigned int> workerThreadCount,
+    worker_pool_type workerPoolType)
+    : pimpl_(std::make_unique<impl>(params, workerThreadCount, workerPoolType))
 {
 }
 
@@ -587,14 +939,50 @@ void ecco_algorithm::import_state(const serialization::node& exportedState)
     pimpl_->import_state(exportedState);
 }
 
+void ecco_algorithm::set_step_metrics(std::shared_ptr<step_metrics> metrics)
+{
+    pimpl_->set_step_metrics(std::move(metrics));
+}
+
 void ecco_algorithm::add_power_bond(cosim::variable_id input_a, cosim::variable_id output_a, cosim::variable_id input_b, cosim::variable_id output_b)
 {
     pimpl_->add_power_bond(input_a, output_a, input_b, output_b);
 }
 
-std::vector<double> ecco_algorithm::get_powerbond_energies(cosim::simulator_index simulator_index)
+void ecco_algorithm::set_energy_window_size(std::size_t size)
+{
+    pimpl_->set_energy_window_size(size);
+}
+
+std::vector<double> ecco_algorithm::get_powerbond_energies(std::size_t index) const
+{
+    return pimpl_->get_powerbond_energies(index);
+}
+
+powerbond_energy_stats ecco_algorithm::get_powerbond_energy_stats(std::size_t index) const
 {
-    return pimpl_->get_powerbond_energies(simulator_index);
+    return pimpl_->get_powerbond_energy_stats(index);
 }
 
+void ecco_algorithm::set_step_rejection(bool enable)
+{
+    pimpl_->set_step_rejection(enable);
+}
+
+std::int64_t ecco_algorithm::get_rejected_step_count() const
+{
+    return pimpl_->get_rejected_step_count();
+}
+
+void ecco_algorithm::set_parallel_transfers(bool enable)
+{
+    pimpl_->set_parallel_transfers(enable);
+}
+
+void ecco_algorithm::set_pipelined_stepping(bool enable)
+{
+    pimpl_->set_pipelined_stepping(enable);
+}
+
+
 } // namespace cosim
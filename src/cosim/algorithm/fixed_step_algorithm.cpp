@@ -5,13 +5,17 @@
  */
 #include "cosim/algorithm/fixed_step_algorithm.hpp"
 
+#include "cosim/algorithm/transfer_plan.hpp"
+#include "cosim/algorithm/worker_pool.hpp"
 #include "cosim/error.hpp"
 #include "cosim/exception.hpp"
 #include "cosim/log/logger.hpp"
-#include "cosim/utility/thread_pool.hpp"
 
 #include <algorithm>
 #include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <unordered_map>
@@ -49,15 +53,21 @@ int calculate_decimation_factor(
 class fixed_step_algorithm::impl
 {
 public:
-    explicit impl(duration baseStepSize, std::optional<unsigned int> workerThreadCount)
+    explicit impl(
+        duration baseStepSize,
+        std::optional<unsigned int> workerThreadCount,
+        worker_pool_type workerPoolType)
         : baseStepSize_(baseStepSize)
-        , pool_(std::min(workerThreadCount.value_or(max_threads_), max_threads_))
+        , workers_(std::min(workerThreadCount.value_or(max_threads_), max_threads_), workerPoolType)
     {
         COSIM_INPUT_CHECK(baseStepSize.count() > 0);
     }
 
-    explicit impl(fixed_step_algorithm_params params, std::optional<unsigned int> workerThreadCount)
-        : impl(params.stepSize, workerThreadCount)
+    explicit impl(
+        fixed_step_algorithm_params params,
+        std::optional<unsigned int> workerThreadCount,
+        worker_pool_type workerPoolType)
+        : impl(params.stepSize, workerThreadCount, workerPoolType)
     {
     }
 
@@ -72,46 +82,64 @@ public:
     void add_simulator(simulator_index i, simulator* s, duration stepSizeHint)
     {
         assert(simulators_.count(i) == 0);
-        simulators_[i].sim = s;
-        simulators_[i].decimationFactor =
+        auto& info = simulators_[i];
+        info.sim = s;
+        info.decimationFactor =
             calculate_decimation_factor(s->name(), baseStepSize_, stepSizeHint);
+        simulatorList_.push_back(&info);
+        transferPlanValid_ = false;
     }
 
     void remove_simulator(simulator_index i)
     {
-        simulators_.erase(i);
+        if (const auto it = simulators_.find(i); it != simulators_.end()) {
+            simulatorList_.erase(
+                std::find(simulatorList_.begin(), simulatorList_.end(), &it->second));
+            simulators_.erase(it);
+        }
         disconnect_simulator_variables(i);
+        transferPlanValid_ = false;
     }
 
     void add_function(function_index i, function* f)
     {
         assert(functions_.count(i) == 0);
         functions_[i].fun = f;
+        transferPlanValid_ = false;
     }
 
     void connect_variables(variable_id output, variable_id input)
     {
         auto& sourceSimInfo = simulators_.at(output.simulator);
         auto& targetSimInfo = simulators_.at(input.simulator);
-        sourceSimInfo.sim->expose_for_getting(output.type, output.reference);
-        targetSimInfo.sim->expose_for_setting(input.type, input.reference);
-        sourceSimInfo.outgoingSimConnections.push_back({output, input});
+        const auto sourceSlot = sourceSimInfo.sim->expose_for_periodic_getting(
+            output.type,
+            output.reference,
+            std::lcm(sourceSimInfo.decimationFactor, targetSimInfo.decimationFactor));
+        const auto targetSlot = targetSimInfo.sim->expose_for_setting(input.type, input.reference);
+        sourceSimInfo.outgoingSimConnections.push_back({output, input, sourceSlot, targetSlot});
+        transferPlanValid_ = false;
     }
 
     void connect_variables(variable_id output, function_io_id input)
     {
         auto& simInfo = simulators_.at(output.simulator);
-        simInfo.sim->expose_for_getting(output.type, output.reference);
-        simInfo.outgoingFunConnections.push_back({output, input});
+        const auto sourceSlot = simInfo.sim->expose_for_periodic_getting(
+            output.type,
+            output.reference,
+            std::lcm(simInfo.decimationFactor, functions_.at(input.function).decimationFactor));
+        simInfo.outgoingFunConnections.push_back({output, input, sourceSlot});
+        transferPlanValid_ = false;
     }
 
     void connect_variables(function_io_id output, variable_id input)
     {
         auto& funInfo = functions_.at(output.function);
         auto& simInfo = simulators_.at(input.simulator);
-        simInfo.sim->expose_for_setting(input.type, input.reference);
-        funInfo.outgoingSimConnections.push_back({output, input});
+        const auto targetSlot = simInfo.sim->expose_for_setting(input.type, input.reference);
+        funInfo.outgoingSimConnections.push_back({output, input, targetSlot});
         update_function_decimation_factor(funInfo);
+        transferPlanValid_ = false;
     }
 
     void disconnect_variable(variable_id input)
@@ -124,6 +152,7 @@ public:
                 [input](const auto& c) { return c.target == input; });
             if (it != conns.end()) {
                 conns.erase(it);
+                transferPlanValid_ = false;
                 // There can be only one connection to an input variable,
                 // so we return as early as possible.
                 return;
@@ -141,6 +170,7 @@ public:
                 [input](const auto& c) { return c.target == input; });
             if (it != conns.end()) {
                 conns.erase(it);
+                transferPlanValid_ = false;
                 // There can be only one connection to an input variable,
                 // so we return as early as possible.
                 return;
@@ -156,33 +186,31 @@ public:
 
     void initialize()
     {
-        for (auto& s : simulators_) {
-            pool_.submit([&] {
-                s.second.sim->setup(startTime_, stopTime_, std::nullopt);
-            });
-        }
-        pool_.wait_for_tasks_to_finish();
-
-        // Run N iterations of the simulators' and functions' step/calculation
-        // procedures, where N is the number of simulators in the system,
-        // to propagate initial values.
-        for (std::size_t i = 0; i < simulators_.size() + functions_.size(); ++i) {
-            for (auto& s : simulators_) {
-                pool_.submit([&] {
-                    s.second.sim->do_iteration();
-                });
-            }
-            pool_.wait_for_tasks_to_finish();
-            calculate_and_transfer();
-        }
-
+        workers_.for_each(simulatorList_, [&](simulator_info& info) {
+            info.sim->setup(startTime_, stopTime_, std::nullopt);
+        });
+
+        // Evaluate every simulator once, so the values set during setup
+        // are applied and reflected in the outputs.  Then propagate initial
+        // values through the system in dependency order, iterating only on
+        // algebraic loops, and finally perform all transfers once more so
+        // the final outputs reach their targets.
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            info.sim->do_iteration();
+        });
+        if (!transferPlanValid_) compile_transfer_plan();
+        std::vector<simulator*> simulators;
+        simulators.reserve(simulatorList_.size());
+        for (const auto info : simulatorList_) simulators.push_back(info->sim);
+        transferPlan_.propagate_initial_values(
+            simulators,
+            std::max<std::size_t>(simulators_.size() + functions_.size(), 1),
+            [this](std::size_t count, const auto& task) { workers_.parallel_for(count, task); });
+        calculate_and_transfer();
 
-        for (auto& s : simulators_) {
-            pool_.submit([&] {
-                s.second.sim->start_simulation();
-            });
-        }
-        pool_.wait_for_tasks_to_finish();
+        workers_.for_each(simulatorList_, [](simulator_info& info) {
+            info.sim->start_simulation();
+        });
         calculate_and_transfer();
     }
 
@@ -193,32 +221,47 @@ public:
         std::stringstream errMessages;
         std::unordered_set<simulator_index> finished;
 
-        // Initiate simulator time steps.
-        for (auto& s : simulators_) {
-            auto& info = s.second;
+        // In pipelined mode, the transfers for the next base step are
+        // performed as soon as their dependencies are done stepping.
+        if (pipelinedStepping_) start_transfer_pipeline(stepCounter_ + 1);
+
+        // Perform simulator time steps, and wait for all of them to finish.
+        workers_.for_each(simulatorList_, [&](simulator_info& info) {
             if (stepCounter_ % info.decimationFactor == 0) {
-                pool_.submit([&] {
-                    try {
-                        const auto stepResult = info.sim->do_step(currentT, baseStepSize_ * info.decimationFactor);
-
-                        if (stepResult != step_result::complete) {
-                            std::lock_guard<std::mutex> lck(m);
-                            errMessages
-                                << info.sim->name() << ": "
-                                << "Step not complete" << '\n';
-                            failed = true;
-                        }
-
-                    } catch (std::exception& ex) {
+                try {
+                    info.sim->set_next_step_number(stepCounter_ + info.decimationFactor);
+                    const auto stepResult = info.sim->do_step(currentT, baseStepSize_ * info.decimationFactor);
+
+                    if (stepResult != step_result::complete) {
                         std::lock_guard<std::mutex> lck(m);
                         errMessages
                             << info.sim->name() << ": "
-                            << ex.what() << '\n';
+                            << "Step not complete" << '\n';
                         failed = true;
                     }
-                });
+
+                } catch (std::exception& ex) {
+                    std::lock_guard<std::mutex> lck(m);
+                    errMessages
+                        << info.sim->name() << ": "
+                        << ex.what() << '\n';
+                    failed = true;
+                }
             }
-        }
+            if (pipelinedStepping_) {
+                // Failed transfers and function calculations are reported
+                // along with the failed time steps.
+                try {
+                    transferPlan_.simulator_done(info.sim);
+                } catch (std::exception& ex) {
+                    std::lock_guard<std::mutex> lck(m);
+                    errMessages
+                        << info.sim->name() << ": "
+                        << ex.what() << '\n';
+                    failed = true;
+                }
+            }
+        });
         ++stepCounter_;
         for (auto& [idx, info] : simulators_) {
             if (stepCounter_ % info.decimationFactor == 0) {
@@ -226,13 +269,15 @@ public:
             }
         }
 
-        // Wait for all time steps to finish, then calculate functions and
-        // transfer variables.
-        pool_.wait_for_tasks_to_finish();
+        // Calculate functions and transfer variables.
         if (failed) {
             throw error(make_error_code(errc::simulation_error), errMessages.str());
         }
-        calculate_and_transfer();
+        if (pipelinedStepping_) {
+            transferPlan_.record_pipeline_time(stepMetrics_.get());
+        } else {
+            calculate_and_transfer();
+        }
 
         return {baseStepSize_, std::move(finished)};
     }
@@ -263,6 +308,22 @@ public:
     {
         COSIM_INPUT_CHECK(factor > 0);
         simulators_.at(i).decimationFactor = factor;
+        transferPlanValid_ = false;
+    }
+
+    void set_parallel_transfers(bool enable)
+    {
+        parallelTransfers_ = enable;
+    }
+
+    void set_pipelined_stepping(bool enable)
+    {
+        pipelinedStepping_ = enable;
+    }
+
+    void set_step_metrics(std::shared_ptr<step_metrics> metrics)
+    {
+        stepMetrics_ = std::move(metrics);
     }
 
 
@@ -271,18 +332,22 @@ private:
     {
         variable_id source;
         variable_id target;
+        variable_slot sourceSlot;
+        variable_slot targetSlot;
     };
 
     struct connection_sf
     {
         variable_id source;
         function_io_id target;
+        variable_slot sourceSlot;
     };
 
     struct connection_fs
     {
         function_io_id source;
         variable_id target;
+        variable_slot targetSlot;
     };
 
     struct simulator_info
@@ -333,119 +398,32 @@ private:
             });
     }
 
-    void calculate_and_transfer()
-    {
-        // Transfer the outputs from simulators that have finished their
-        // individual time steps within the current co-simulation time step.
-        for (const auto& s : simulators_) {
-            if (stepCounter_ % s.second.decimationFactor == 0) {
-                transfer_variables(s.second.outgoingSimConnections);
-                transfer_variables(s.second.outgoingFunConnections);
-            }
-        }
-        // Calculate functions and transfer their outputs to simulators.
-        for (const auto& f : functions_) {
-            if (stepCounter_ % f.second.decimationFactor == 0) {
-                f.second.fun->calculate();
-                transfer_variables(f.second.outgoingSimConnections);
-            }
-        }
-    }
-
-    void transfer_variables(const std::vector<connection_ss>& connections)
-    {
-        for (const auto& c : connections) {
-            const auto sdf = simulators_.at(c.source.simulator).decimationFactor;
-            const auto tdf = simulators_.at(c.target.simulator).decimationFactor;
-            if (stepCounter_ % std::lcm(sdf, tdf) == 0) {
-                transfer_variable(c);
-            }
-        }
-    }
-
-    void transfer_variables(const std::vector<connection_sf>& connections)
-    {
-        for (const auto& c : connections) {
-            const auto sdf = simulators_.at(c.source.simulator).decimationFactor;
-            const auto tdf = functions_.at(c.target.function).decimationFactor;
-            if (stepCounter_ % std::lcm(sdf, tdf) == 0) {
-                transfer_variable(c);
-            }
-        }
-    }
-
-    void transfer_variables(const std::vector<connection_fs>& connections)
+    void start_transfer_pipeline(std::int64_t n)
     {
-        for (const auto& c : connections) {
-            const auto sdf = functions_.at(c.source.function).decimationFactor;
-            const auto tdf = simulators_.at(c.target.simulator).decimationFactor;
-            if (stepCounter_ % std::lcm(sdf, tdf) == 0) {
-                transfer_variable(c);
-            }
-        }
+        if (!transferPlanValid_) compile_transfer_plan();
+        const auto metrics = stepMetrics_.get();
+        transferPlan_.start_pipeline(n, metrics && metrics->enabled());
     }
 
-    void transfer_variable(const connection_ss& c)
-    {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                simulators_.at(c.target.simulator).sim->set_real(c.target.reference, simulators_.at(c.source.simulator).sim->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                simulators_.at(c.target.simulator).sim->set_integer(c.target.reference, simulators_.at(c.source.simulator).sim->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                simulators_.at(c.target.simulator).sim->set_boolean(c.target.reference, simulators_.at(c.source.simulator).sim->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                simulators_.at(c.target.simulator).sim->set_string(c.target.reference, simulators_.at(c.source.simulator).sim->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
-    }
-
-    void transfer_variable(const connection_sf& c)
+    void calculate_and_transfer()
     {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                functions_.at(c.target.function).fun->set_real(c.target.reference, simulators_.at(c.source.simulator).sim->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                functions_.at(c.target.function).fun->set_integer(c.target.reference, simulators_.at(c.source.simulator).sim->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                functions_.at(c.target.function).fun->set_boolean(c.target.reference, simulators_.at(c.source.simulator).sim->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                functions_.at(c.target.function).fun->set_string(c.target.reference, simulators_.at(c.source.simulator).sim->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
+        if (!transferPlanValid_) compile_transfer_plan();
+        transferPlan_.execute(
+            stepCounter_,
+            parallelTransfers_ ? &workers_ : nullptr,
+            stepMetrics_.get());
     }
 
-    void transfer_variable(const connection_fs& c)
+    // Compiles the connection graph into `transferPlan_`, taking the
+    // decimation factors into account.
+    void compile_transfer_plan()
     {
-        assert(c.source.type == c.target.type);
-        switch (c.target.type) {
-            case variable_type::real:
-                simulators_.at(c.target.simulator).sim->set_real(c.target.reference, functions_.at(c.source.function).fun->get_real(c.source.reference));
-                break;
-            case variable_type::integer:
-                simulators_.at(c.target.simulator).sim->set_integer(c.target.reference, functions_.at(c.source.function).fun->get_integer(c.source.reference));
-                break;
-            case variable_type::boolean:
-                simulators_.at(c.target.simulator).sim->set_boolean(c.target.reference, functions_.at(c.source.function).fun->get_boolean(c.source.reference));
-                break;
-            case variable_type::string:
-                simulators_.at(c.target.simulator).sim->set_string(c.target.reference, functions_.at(c.source.function).fun->get_string(c.source.reference));
-                break;
-            case variable_type::enumeration:
-                COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
-        }
+        detail::compile_transfer_plan(
+            transferPlan_,
+            simulators_,
+            functions_,
+            [](const auto& info) { return info.decimationFactor; });
+        transferPlanValid_ = true;
     }
 
     // Algorithm parameters
@@ -458,21 +436,38 @@ private:
     std::unordered_map<simulator_index, simulator_info> simulators_;
     std::unordered_map<function_index, function_info> functions_;
 
+    // The elements of `simulators_` in the order they were added, so that
+    // each simulator keeps a stable task index in the worker pool.
+    std::vector<simulator_info*> simulatorList_;
+
     // Simulation state
     std::int64_t stepCounter_ = 0;
 
+    // Variable transfers, compiled from the system structure on demand
+    detail::transfer_plan transferPlan_;
+    bool transferPlanValid_ = false;
+    bool parallelTransfers_ = false;
+    bool pipelinedStepping_ = false;
+    std::shared_ptr<step_metrics> stepMetrics_;
+
     // Other
-    utility::thread_pool pool_;
+    detail::worker_pool workers_;
 };
 
 
-fixed_step_algorithm::fixed_step_algorithm(duration baseStepSize, std::optional<unsigned int> workerThreadCount)
-    : pimpl_(std::make_unique<impl>(baseStepSize, workerThreadCount))
+fixed_step_algorithm::fixed_step_algorithm(
+    duration baseStepSize,
+    std::optional<unsigned int> workerThreadCount,
+    worker_pool_type workerPoolType)
+    : pimpl_(std::make_unique<impl>(baseStepSize, workerThreadCount, workerPoolType))
 {
 }
 
-fixed_step_algorithm::fixed_step_algorithm(fixed_step_algorithm_params params, std::optional<unsigned int> workerThreadCount)
-    : fixed_step_algorithm(params.stepSize, workerThreadCount)
+fixed_step_algorithm::fixed_step_algorithm(
+    fixed_step_algorithm_params params,
+    std::optional<unsigned int> workerThreadCount,
+    worker_pool_type workerPoolType)
+    : fixed_step_algorithm(params.stepSize, workerThreadCount, workerPoolType)
 {
 }
 
@@ -570,10 +565,26 @@ void fixed_step_algorithm::import_state(const serialization::node& exportedState
     pimpl_->import_state(exportedState);
 }
 
+void fixed_step_algorithm::set_step_metrics(std::shared_ptr<step_metrics> metrics)
+{
+    pimpl_->set_step_metrics(std::move(metrics));
+}
+
 void fixed_step_algorithm::set_stepsize_decimation_factor(cosim::simulator_index simulator, int factor)
 {
     pimpl_->set_stepsize_decimation_factor(simulator, factor);
 }
 
 
+void fixed_step_algorithm::set_parallel_transfers(bool enable)
+{
+    pimpl_->set_parallel_transfers(enable);
+}
+
+void fixed_step_algorithm::set_pipelined_stepping(bool enable)
+{
+    pimpl_->set_pipelined_stepping(enable);
+}
+
+
 } // namespace cosim
@@ -0,0 +1,630 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "cosim/algorithm/transfer_plan.hpp"
+
+#include "cosim/error.hpp"
+#include "cosim/log/logger.hpp"
+#include "cosim/step_timer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+
+namespace cosim
+{
+namespace detail
+{
+
+
+template<typename Source, typename SourceRef, typename Target, typename TargetRef>
+void transfer_list<Source, SourceRef, Target, TargetRef>::add(
+    variable_type type,
+    Source* source,
+    const SourceRef& sourceRef,
+    Target* target,
+    const TargetRef& targetRef)
+{
+    const auto t = transfer{source, sourceRef, target, targetRef};
+    switch (type) {
+        case variable_type::real:
+            reals_.push_back(t);
+            break;
+        case variable_type::integer:
+            integers_.push_back(t);
+            break;
+        case variable_type::boolean:
+            booleans_.push_back(t);
+            break;
+        case variable_type::string:
+            strings_.push_back(t);
+            break;
+        case variable_type::enumeration:
+            COSIM_PANIC_M("Can't handle variable of type 'enumeration' yet");
+    }
+}
+
+
+namespace
+{
+
+// Returns whether two values are equal, for the purpose of detecting
+// convergence.  Real values are compared with a tolerance.
+template<typename T>
+bool converged(const T& previous, const T& value)
+{
+    if constexpr (std::is_same_v<T, double>) {
+        const auto scale = std::max(std::abs(previous), std::abs(value));
+        return std::abs(value - previous) <=
+            transfer_plan::initialization_absolute_tolerance +
+            transfer_plan::initialization_relative_tolerance * scale;
+    } else {
+        return previous == value;
+    }
+}
+
+
+// Records `value` at position `pos` in `values`, advances `pos`, and returns
+// whether it differs from the value previously recorded there.
+template<typename T, typename V>
+bool record_value(std::vector<scalar_value>& values, std::size_t& pos, const V& value)
+{
+    if (pos == values.size()) {
+        values.emplace_back(T(value));
+        ++pos;
+        return true;
+    }
+    auto& recorded = values[pos++];
+    const auto* previous = std::get_if<T>(&recorded);
+    const bool changed = !previous || !converged(*previous, T(value));
+    recorded = T(value);
+    return changed;
+}
+
+
+// Returns the strongly connected components of a directed graph, given as
+// adjacency lists, in topological order.  This is Tarjan's algorithm,
+// in a non-recursive formulation.
+std::vector<std::vector<std::size_t>> strongly_connected_components(
+    const std::vector<std::vector<std::size_t>>& successors)
+{
+    constexpr auto unvisited = std::numeric_limits<std::size_t>::max();
+    const auto nodeCount = successors.size();
+    std::vector<std::size_t> index(nodeCount, unvisited);
+    std::vector<std::size_t> lowLink(nodeCount);
+    std::vector<bool> onStack(nodeCount, false);
+    std::vector<std::size_t> stack;
+    std::vector<std::pair<std::size_t, std::size_t>> callStack; // (node, next successor)
+    std::vector<std::vector<std::size_t>> components;
+    std::size_t nextIndex = 0;
+
+    for (std::size_t root = 0; root < nodeCount; ++root) {
+        if (index[root] != unvisited) continue;
+        callStack.emplace_back(root, 0);
+        while (!callStack.empty()) {
+            auto& [node, next] = callStack.back();
+            if (next == 0 && index[node] == unvisited) {
+                index[node] = lowLink[node] = nextIndex++;
+                stack.push_back(node);
+                onStack[node] = true;
+            }
+            if (next < successors[node].size()) {
+                const auto succ = successors[node][next++];
+                if (index[succ] == unvisited) {
+                    callStack.emplace_back(succ, 0);
+                } else if (onStack[succ]) {
+                    lowLink[node] = std::min(lowLink[node], index[succ]);
+                }
+                continue;
+            }
+            const auto finished = node;
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                const auto parent = callStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[finished]);
+            }
+            if (lowLink[finished] == index[finished]) {
+                auto& component = components.emplace_back();
+                std::size_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    component.push_back(member);
+                } while (member != finished);
+                std::reverse(component.begin(), component.end());
+            }
+        }
+    }
+    // Tarjan's algorithm finds the components in reverse topological order.
+    std::reverse(components.begin(), components.end());
+    return components;
+}
+
+
+// Returns the phase with the given period in `phases`, adding it if necessary.
+template<typename Phase>
+Phase& find_or_add_phase(std::vector<Phase>& phases, std::int64_t period)
+{
+    assert(period > 0);
+    const auto it = std::find_if(
+        phases.begin(),
+        phases.end(),
+        [period](const auto& p) { return p.period == period; });
+    if (it != phases.end()) return *it;
+    auto& phase = phases.emplace_back();
+    phase.period = period;
+    return phase;
+}
+
+} // namespace
+
+
+template<typename Source, typename SourceRef, typename Target, typename TargetRef>
+bool transfer_list<Source, SourceRef, Target, TargetRef>::execute_and_compare(
+    std::vector<scalar_value>& values,
+    std::size_t& pos) const
+{
+    bool changed = false;
+    for (const auto& t : reals_) {
+        const auto v = t.source->get_real(t.sourceRef);
+        t.target->set_real(t.targetRef, v);
+        if (record_value<double>(values, pos, v)) changed = true;
+    }
+    for (const auto& t : integers_) {
+        const auto v = t.source->get_integer(t.sourceRef);
+        t.target->set_integer(t.targetRef, v);
+        if (record_value<int>(values, pos, v)) changed = true;
+    }
+    for (const auto& t : booleans_) {
+        const auto v = t.source->get_boolean(t.sourceRef);
+        t.target->set_boolean(t.targetRef, v);
+        if (record_value<bool>(values, pos, v)) changed = true;
+    }
+    for (const auto& t : strings_) {
+        const auto v = t.source->get_string(t.sourceRef);
+        t.target->set_string(t.targetRef, v);
+        if (record_value<std::string>(values, pos, v)) changed = true;
+    }
+    return changed;
+}
+
+
+void transfer_plan::add_transfer(
+    std::int64_t period,
+    variable_type type,
+    simulator* source,
+    variable_slot sourceSlot,
+    simulator* target,
+    variable_slot targetSlot)
+{
+    const auto group = simulator_group_index(target);
+    add_simulator_group_source(group, source);
+    if (source == target) simulatorGroups_[group].selfConnected = true;
+    find_or_add_phase(simulatorGroups_[group].phases, period)
+        .fromSimulators.add(type, source, sourceSlot, target, targetSlot);
+}
+
+
+void transfer_plan::add_transfer(
+    std::int64_t period,
+    variable_type type,
+    simulator* source,
+    variable_slot sourceSlot,
+    function* target,
+    const function_io_reference& targetRef)
+{
+    const auto group = function_group_index(target);
+    add_function_group_source(group, source);
+    find_or_add_phase(functionGroups_[group].phases, period)
+        .fromSimulators.add(type, source, sourceSlot, target, targetRef);
+}
+
+
+void transfer_plan::add_transfer(
+    std::int64_t period,
+    variable_type type,
+    function* source,
+    const function_io_reference& sourceRef,
+    simulator* target,
+    variable_slot targetSlot)
+{
+    const auto group = simulator_group_index(target);
+    add_simulator_group_source_function(group, function_group_index(source));
+    find_or_add_phase(simulatorGroups_[group].phases, period)
+        .fromFunctions.add(type, source, sourceRef, target, targetSlot);
+}
+
+
+void transfer_plan::add_function(std::int64_t period, function* fun)
+{
+    assert(period > 0);
+    auto& group = functionGroups_.emplace_back();
+    group.fun = fun;
+    group.period = period;
+}
+
+
+void transfer_plan::execute(std::int64_t n, worker_pool* workers, step_metrics* metrics) const
+{
+    const auto forEach = [workers](std::size_t count, const auto& task) {
+        workers->parallel_for(count, task);
+    };
+    {
+        const auto timer = step_timer(metrics, &step_metrics::functions);
+        if (workers) {
+            execute_functions(n, forEach);
+        } else {
+            execute_functions(n);
+        }
+    }
+    {
+        const auto timer = step_timer(metrics, &step_metrics::transfers);
+        if (workers) {
+            execute_transfers(n, forEach);
+        } else {
+            execute_transfers(n);
+        }
+    }
+}
+
+
+void transfer_plan::execute_functions(std::int64_t n) const
+{
+    for (const auto& group : functionGroups_) execute(group, n);
+}
+
+
+void transfer_plan::execute_transfers(std::int64_t n) const
+{
+    for (const auto& group : simulatorGroups_) execute(group, n);
+}
+
+
+void transfer_plan::start_pipeline(std::int64_t n, bool measureTime)
+{
+    pipelineStep_ = n;
+    pipelineTimed_ = measureTime;
+    pipelineFunctionTime_.store(0, std::memory_order_relaxed);
+    pipelineTransferTime_.store(0, std::memory_order_relaxed);
+    if (functionGroupsPending_.size() != functionGroups_.size()) {
+        functionGroupsPending_ = std::vector<std::atomic<std::size_t>>(functionGroups_.size());
+    }
+    if (simulatorGroupsPending_.size() != simulatorGroups_.size()) {
+        simulatorGroupsPending_ = std::vector<std::atomic<std::size_t>>(simulatorGroups_.size());
+    }
+    for (std::size_t i = 0; i < simulatorGroups_.size(); ++i) {
+        const auto& group = simulatorGroups_[i];
+        simulatorGroupsPending_[i].store(
+            group.sourceSimulators.size() + group.sourceFunctionGroups.size(),
+            std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < functionGroups_.size(); ++i) {
+        functionGroupsPending_[i].store(
+            functionGroups_[i].sourceSimulators.size(),
+            std::memory_order_relaxed);
+    }
+    std::exception_ptr firstError;
+    for (std::size_t i = 0; i < functionGroups_.size(); ++i) {
+        if (!functionGroups_[i].sourceSimulators.empty()) continue;
+        try {
+            function_group_ready(i);
+        } catch (...) {
+            if (!firstError) firstError = std::current_exception();
+        }
+    }
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+
+void transfer_plan::record_pipeline_time(step_metrics* metrics) const
+{
+    if (!metrics || !metrics->enabled()) return;
+    metrics->functions.record(pipeline_function_time());
+    metrics->transfers.record(pipeline_transfer_time());
+}
+
+
+void transfer_plan::simulator_done(simulator* sim)
+{
+    const auto it = simulatorDependents_.find(sim);
+    if (it == simulatorDependents_.end()) return;
+    std::exception_ptr firstError;
+    for (const auto i : it->second.functionGroups) {
+        if (functionGroupsPending_[i].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            try {
+                function_group_ready(i);
+            } catch (...) {
+                if (!firstError) firstError = std::current_exception();
+            }
+        }
+    }
+    for (const auto i : it->second.simulatorGroups) {
+        if (simulatorGroupsPending_[i].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            try {
+                simulator_group_ready(i);
+            } catch (...) {
+                if (!firstError) firstError = std::current_exception();
+            }
+        }
+    }
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+
+std::vector<std::vector<transfer_plan::init_component>>
+transfer_plan::initialization_levels(const std::vector<simulator*>& simulators) const
+{
+    // Nodes 0 to N-1 are simulators, and N to N+M-1 are function groups.
+    std::vector<init_node> nodes;
+    std::unordered_map<const simulator*, std::size_t> simulatorNodes;
+    for (auto sim : simulators) {
+        simulatorNodes.emplace(sim, nodes.size());
+        nodes.push_back({sim, nullptr, nullptr});
+    }
+    const auto functionNodeOffset = nodes.size();
+    for (const auto& group : functionGroups_) {
+        nodes.push_back({nullptr, nullptr, &group});
+    }
+    std::vector<std::vector<std::size_t>> successors(nodes.size());
+    std::vector<bool> selfConnected(nodes.size(), false);
+    for (const auto& group : simulatorGroups_) {
+        const auto target = simulatorNodes.at(group.target);
+        nodes[target].simulatorGroup = &group;
+        selfConnected[target] = group.selfConnected;
+        for (const auto source : group.sourceSimulators) {
+            if (source != group.target) {
+                successors[simulatorNodes.at(source)].push_back(target);
+            }
+        }
+        for (const auto source : group.sourceFunctionGroups) {
+            successors[functionNodeOffset + source].push_back(target);
+        }
+    }
+    for (std::size_t i = 0; i < functionGroups_.size(); ++i) {
+        for (const auto source : functionGroups_[i].sourceSimulators) {
+            successors[simulatorNodes.at(source)].push_back(functionNodeOffset + i);
+        }
+    }
+
+    const auto components = strongly_connected_components(successors);
+
+    // Assign each component to the level after the latest level of the
+    // components it depends on.
+    std::vector<std::size_t> nodeComponents(nodes.size());
+    for (std::size_t c = 0; c < components.size(); ++c) {
+        for (const auto node : components[c]) nodeComponents[node] = c;
+    }
+    std::vector<std::size_t> componentLevels(components.size(), 0);
+    std::vector<std::vector<init_component>> levels;
+    for (std::size_t c = 0; c < components.size(); ++c) {
+        const auto level = componentLevels[c];
+        for (const auto node : components[c]) {
+            for (const auto succ : successors[node]) {
+                const auto sc = nodeComponents[succ];
+                if (sc != c) componentLevels[sc] = std::max(componentLevels[sc], level + 1);
+            }
+        }
+        if (levels.size() <= level) levels.resize(level + 1);
+        auto& component = levels[level].emplace_back();
+        for (const auto node : components[c]) component.nodes.push_back(nodes[node]);
+        component.loop = components[c].size() > 1 || selfConnected[components[c].front()];
+    }
+    return levels;
+}
+
+
+void transfer_plan::initialize_component(
+    const init_component& component,
+    std::size_t maxIterations) const
+{
+    if (!component.loop) {
+        initialize_node(component.nodes.front(), nullptr);
+        return;
+    }
+    // Gauss-Seidel iteration until the values transferred within the loop
+    // have converged.
+    std::vector<std::vector<scalar_value>> values(component.nodes.size());
+    for (std::size_t i = 0; i < maxIterations; ++i) {
+        bool changed = false;
+        for (std::size_t n = 0; n < component.nodes.size(); ++n) {
+            if (initialize_node(component.nodes[n], &values[n])) changed = true;
+        }
+        if (!changed) return;
+    }
+    BOOST_LOG_SEV(log::logger(), log::warning)
+        << "Initial values in an algebraic loop of " << component.nodes.size()
+        << " simulators and functions did not converge within "
+        << maxIterations << " iterations";
+}
+
+
+// Performs the transfers to a node and evaluates it.  If `values` is not null,
+// the transferred values are compared with and recorded in it, and the
+// function returns whether any of them changed.
+bool transfer_plan::initialize_node(
+    const init_node& node,
+    std::vector<scalar_value>* values) const
+{
+    bool changed = false;
+    std::size_t pos = 0;
+    const auto transfer = [&](const auto& list) {
+        if (values) {
+            if (list.execute_and_compare(*values, pos)) changed = true;
+        } else {
+            list.execute();
+        }
+    };
+    if (node.functionGroup) {
+        for (const auto& phase : node.functionGroup->phases) transfer(phase.fromSimulators);
+        node.functionGroup->fun->calculate();
+    } else {
+        if (node.simulatorGroup) {
+            for (const auto& phase : node.simulatorGroup->phases) {
+                transfer(phase.fromSimulators);
+                transfer(phase.fromFunctions);
+            }
+        }
+        node.sim->do_iteration();
+    }
+    return changed;
+}
+
+
+void transfer_plan::clear() noexcept
+{
+    functionGroups_.clear();
+    simulatorGroups_.clear();
+    simulatorDependents_.clear();
+}
+
+
+void transfer_plan::execute(const function_group& group, std::int64_t n) const
+{
+    for (const auto& phase : group.phases) {
+        if (n % phase.period == 0) phase.fromSimulators.execute();
+    }
+    if (n % group.period == 0) group.fun->calculate();
+}
+
+
+void transfer_plan::execute(const simulator_group& group, std::int64_t n) const
+{
+    for (const auto& phase : group.phases) {
+        if (n % phase.period == 0) {
+            phase.fromSimulators.execute();
+            phase.fromFunctions.execute();
+        }
+    }
+}
+
+
+std::size_t transfer_plan::function_group_index(function* fun) const
+{
+    const auto it = std::find_if(
+        functionGroups_.begin(),
+        functionGroups_.end(),
+        [fun](const auto& g) { return g.fun == fun; });
+    assert(it != functionGroups_.end());
+    return static_cast<std::size_t>(it - functionGroups_.begin());
+}
+
+
+std::size_t transfer_plan::simulator_group_index(simulator* target)
+{
+    const auto it = std::find_if(
+        simulatorGroups_.begin(),
+        simulatorGroups_.end(),
+        [target](const auto& g) { return g.target == target; });
+    if (it != simulatorGroups_.end()) {
+        return static_cast<std::size_t>(it - simulatorGroups_.begin());
+    }
+    const auto index = simulatorGroups_.size();
+    simulatorGroups_.emplace_back().target = target;
+    add_simulator_group_source(index, target);
+    return index;
+}
+
+
+void transfer_plan::add_function_group_source(std::size_t functionGroup, simulator* source)
+{
+    auto& sources = functionGroups_[functionGroup].sourceSimulators;
+    if (std::find(sources.begin(), sources.end(), source) != sources.end()) return;
+    sources.push_back(source);
+    simulatorDependents_[source].functionGroups.push_back(functionGroup);
+}
+
+
+void transfer_plan::add_simulator_group_source(std::size_t simulatorGroup, simulator* source)
+{
+    auto& sources = simulatorGroups_[simulatorGroup].sourceSimulators;
+    if (std::find(sources.begin(), sources.end(), source) != sources.end()) return;
+    sources.push_back(source);
+    simulatorDependents_[source].simulatorGroups.push_back(simulatorGroup);
+}
+
+
+void transfer_plan::add_simulator_group_source_function(
+    std::size_t simulatorGroup,
+    std::size_t functionGroup)
+{
+    auto& sources = simulatorGroups_[simulatorGroup].sourceFunctionGroups;
+    if (std::find(sources.begin(), sources.end(), functionGroup) != sources.end()) return;
+    sources.push_back(functionGroup);
+    functionGroups_[functionGroup].dependentSimulatorGroups.push_back(simulatorGroup);
+}
+
+
+namespace
+{
+
+// Calls `f()`, and if `timed` is true, adds the time it took to `total`.
+template<typename F>
+void timed_call(bool timed, std::atomic<duration::rep>& total, F&& f)
+{
+    if (!timed) {
+        f();
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const auto record = [&] {
+        const auto elapsed = std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now() - start);
+        total.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    };
+    try {
+        f();
+    } catch (...) {
+        record();
+        throw;
+    }
+    record();
+}
+
+} // namespace
+
+
+void transfer_plan::function_group_ready(std::size_t index)
+{
+    const auto& group = functionGroups_[index];
+    std::exception_ptr error;
+    try {
+        timed_call(pipelineTimed_, pipelineFunctionTime_, [&] {
+            execute(group, pipelineStep_);
+        });
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (const auto i : group.dependentSimulatorGroups) {
+        if (simulatorGroupsPending_[i].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            try {
+                simulator_group_ready(i);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+
+void transfer_plan::simulator_group_ready(std::size_t index)
+{
+    timed_call(pipelineTimed_, pipelineTransferTime_, [&] {
+        execute(simulatorGroups_[index], pipelineStep_);
+    });
+}
+
+
+} // namespace detail
+} // namespace cosim
@@ -0,0 +1,516 @@
+/**
+ *  \file
+ *  Precompiled variable transfer plans for the co-simulation algorithms.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_ALGORITHM_TRANSFER_PLAN_HPP
+#define COSIM_ALGORITHM_TRANSFER_PLAN_HPP
+
+#include "cosim/algorithm/worker_pool.hpp"
+
+#include <cosim/algorithm/simulator.hpp>
+#include <cosim/function/function.hpp>
+#include <cosim/model_description.hpp>
+#include <cosim/step_metrics.hpp>
+#include <cosim/time.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+
+namespace cosim
+{
+namespace detail
+{
+
+/**
+ *  A flat list of variable transfers between two kinds of endpoints
+ *  (simulators or functions), segregated by variable type.
+ *
+ *  `Source` and `Target` must be `simulator` or `function`.  Simulator
+ *  variables are referred to by `variable_slot`, and function variables by
+ *  `function_io_reference`.
+ */
+template<typename Source, typename SourceRef, typename Target, typename TargetRef>
+class transfer_list
+{
+public:
+    /// Adds a transfer from `sourceRef` in `source` to `targetRef` in `target`.
+    void add(
+        variable_type type,
+        Source* source,
+        const SourceRef& sourceRef,
+        Target* target,
+        const TargetRef& targetRef);
+
+    /**
+     *  Performs all transfers, like `execute()`, and records the transferred
+     *  values in `values`, starting at position `pos`, which is advanced past
+     *  the last recorded value.  Returns whether any of the values differ
+     *  from the ones that were recorded there before.
+     */
+    bool execute_and_compare(std::vector<scalar_value>& values, std::size_t& pos) const;
+
+    /// Performs all transfers.
+    void execute() const
+    {
+        for (const auto& t : reals_) {
+            t.target->set_real(t.targetRef, t.source->get_real(t.sourceRef));
+        }
+        for (const auto& t : integers_) {
+            t.target->set_integer(t.targetRef, t.source->get_integer(t.sourceRef));
+        }
+        for (const auto& t : booleans_) {
+            t.target->set_boolean(t.targetRef, t.source->get_boolean(t.sourceRef));
+        }
+        for (const auto& t : strings_) {
+            t.target->set_string(t.targetRef, t.source->get_string(t.sourceRef));
+        }
+    }
+
+    /// Returns whether the list is empty.
+    bool empty() const noexcept
+    {
+        return reals_.empty() && integers_.empty() && booleans_.empty() && strings_.empty();
+    }
+
+private:
+    struct transfer
+    {
+        Source* source;
+        SourceRef sourceRef;
+        Target* target;
+        TargetRef targetRef;
+    };
+
+    std::vector<transfer> reals_;
+    std::vector<transfer> integers_;
+    std::vector<transfer> booleans_;
+    std::vector<transfer> strings_;
+};
+
+
+/**
+ *  A precompiled plan for the variable transfers and function calculations
+ *  that take place after each co-simulation step.
+ *
+ *  The plan is built once from the algorithm's connection graph, and replaces
+ *  per-connection map lookups, decimation factor arithmetic and type
+ *  dispatching with tight loops over contiguous arrays.  Transfers are
+ *  grouped in *phases* according to their period, i.e., the number of base
+ *  steps between each time they are performed.  In `execute(n)`, a phase is
+ *  included if its period divides `n`.
+ *
+ *  Transfers are furthermore partitioned by their target, so that the plan
+ *  can be executed in two stages, each of which consists of independent
+ *  tasks which may run concurrently:
+ *
+ *   1. For each function: the transfers from simulators to the function,
+ *      followed by the function's calculation (if its period divides `n`).
+ *   2. For each target simulator: the transfers from simulators and
+ *      functions to that simulator.
+ *
+ *  Since a function's inputs can only be connected to simulator outputs,
+ *  the functions don't depend on each other, and the result is the same
+ *  as if all transfers and calculations were performed in sequence.
+ *
+ *  The plan also supports *pipelined* execution, where each group is
+ *  executed as soon as the simulators and functions it depends on are
+ *  done, rather than after a barrier.  See `start_pipeline()`.
+ *
+ *  Finally, the plan's dependency graph is used to propagate initial values
+ *  through the system in dependency order.  See `propagate_initial_values()`.
+ */
+class transfer_plan
+{
+public:
+    /// Absolute tolerance for real values in `propagate_initial_values()`.
+    static constexpr double initialization_absolute_tolerance = 1e-12;
+
+    /// Relative tolerance for real values in `propagate_initial_values()`.
+    static constexpr double initialization_relative_tolerance = 1e-9;
+
+    /// Adds a simulator-to-simulator transfer with the given period.
+    void add_transfer(
+        std::int64_t period,
+        variable_type type,
+        simulator* source,
+        variable_slot sourceSlot,
+        simulator* target,
+        variable_slot targetSlot);
+
+    /**
+     *  Adds a simulator-to-function transfer with the given period.
+     *
+     *  The target function must have been added with `add_function()` first.
+     */
+    void add_transfer(
+        std::int64_t period,
+        variable_type type,
+        simulator* source,
+        variable_slot sourceSlot,
+        function* target,
+        const function_io_reference& targetRef);
+
+    /**
+     *  Adds a function-to-simulator transfer with the given period.
+     *
+     *  The source function must have been added with `add_function()` first.
+     */
+    void add_transfer(
+        std::int64_t period,
+        variable_type type,
+        function* source,
+        const function_io_reference& sourceRef,
+        simulator* target,
+        variable_slot targetSlot);
+
+    /// Adds a function calculation with the given period.
+    void add_function(std::int64_t period, function* fun);
+
+    /// Performs the transfers and calculations for base step number `n`.
+    void execute(std::int64_t n) const
+    {
+        execute_functions(n);
+        execute_transfers(n);
+    }
+
+    /**
+     *  Performs the transfers and calculations for base step number `n`,
+     *  possibly in parallel.
+     *
+     *  `forEach(count, task)` must call `task(i)` for every `i` in the range
+     *  `[0, count)`, possibly concurrently, and return when all calls have
+     *  completed.
+     */
+    template<typename ForEach>
+    void execute(std::int64_t n, ForEach&& forEach) const
+    {
+        execute_functions(n, forEach);
+        execute_transfers(n, forEach);
+    }
+
+    /**
+     *  Performs the transfers and calculations for base step number `n`,
+     *  and records the time spent on each stage in `metrics`.
+     *
+     *  If `workers` is not null, the tasks of each stage are run in parallel
+     *  on it.  `metrics` may be null.
+     */
+    void execute(std::int64_t n, worker_pool* workers, step_metrics* metrics) const;
+
+    /**
+     *  Performs the first stage of `execute(n)`, i.e., the transfers to
+     *  functions and the function calculations.
+     */
+    void execute_functions(std::int64_t n) const;
+
+    /// Parallel version of `execute_functions()`; see `execute()`.
+    template<typename ForEach>
+    void execute_functions(std::int64_t n, ForEach&& forEach) const
+    {
+        forEach(functionGroups_.size(), [this, n](std::size_t i) {
+            execute(functionGroups_[i], n);
+        });
+    }
+
+    /**
+     *  Performs the second stage of `execute(n)`, i.e., the transfers to
+     *  simulators.
+     */
+    void execute_transfers(std::int64_t n) const;
+
+    /// Parallel version of `execute_transfers()`; see `execute()`.
+    template<typename ForEach>
+    void execute_transfers(std::int64_t n, ForEach&& forEach) const
+    {
+        forEach(simulatorGroups_.size(), [this, n](std::size_t i) {
+            execute(simulatorGroups_[i], n);
+        });
+    }
+
+    /**
+     *  Prepares for pipelined execution of the plan for base step number `n`.
+     *
+     *  After this, `simulator_done()` must be called once for every
+     *  simulator in the system (including ones which are not stepped in
+     *  this base step), as soon as the simulator is done stepping.  Each
+     *  group is executed by the thread whose call to `simulator_done()`
+     *  completes its dependencies, which are the simulators that are read
+     *  and written by the group, and for simulator groups, the source
+     *  functions.  When all calls have returned, the plan has been fully
+     *  executed.
+     *
+     *  If `measureTime` is true, the time spent executing function groups
+     *  and simulator groups is summed up, and may be retrieved with
+     *  `pipeline_function_time()` and `pipeline_transfer_time()` when
+     *  all calls to `simulator_done()` have returned.
+     *
+     *  This function may execute function groups which don't depend on any
+     *  simulators, and must not be called concurrently with any other
+     *  member function.  Exceptions are handled as in `simulator_done()`.
+     */
+    void start_pipeline(std::int64_t n, bool measureTime = false);
+
+    /**
+     *  Signals that a simulator is done stepping, and executes any groups
+     *  whose dependencies are now complete.
+     *
+     *  This may be called concurrently for different simulators.  If the
+     *  execution of a group throws, the dependencies of the remaining groups
+     *  are still updated, and the first exception is rethrown at the end.
+     *  Groups which depend on the failed group are executed regardless.
+     */
+    void simulator_done(simulator* sim);
+
+    /**
+     *  Returns the total time spent executing function groups (transfers
+     *  to functions and function calculations) in the current pipeline,
+     *  summed over all threads.
+     */
+    duration pipeline_function_time() const noexcept
+    {
+        return duration(pipelineFunctionTime_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     *  Returns the total time spent executing simulator groups (transfers to
+     *  simulators) in the current pipeline, summed over all threads.
+     */
+    duration pipeline_transfer_time() const noexcept
+    {
+        return duration(pipelineTransferTime_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     *  Records `pipeline_function_time()` and `pipeline_transfer_time()` in
+     *  `metrics`, if it is not null and enabled.
+     */
+    void record_pipeline_time(step_metrics* metrics) const;
+
+    /**
+     *  Propagates initial values through the system, using the simulators'
+     *  `do_iteration()` functions.
+     *
+     *  The simulators and functions are evaluated in topological order of
+     *  the dependency graph, each after the transfers to it have been
+     *  performed.  Strongly connected components of the graph (algebraic
+     *  loops) are evaluated repeatedly, until none of the values transferred
+     *  within them change or `maxLoopIterations` is reached, in which case a
+     *  warning is logged.  Real values are considered unchanged if they
+     *  differ by no more than `initialization_absolute_tolerance` plus
+     *  `initialization_relative_tolerance` times their magnitude.  Components
+     *  which don't depend on each other are evaluated with `forEach`, whose
+     *  requirements are as for `execute()`.
+     *
+     *  `simulators` must contain all simulators in the system, including
+     *  ones that aren't connected to anything.
+     */
+    template<typename ForEach>
+    void propagate_initial_values(
+        const std::vector<simulator*>& simulators,
+        std::size_t maxLoopIterations,
+        ForEach&& forEach) const
+    {
+        const auto levels = initialization_levels(simulators);
+        for (const auto& level : levels) {
+            forEach(level.size(), [&](std::size_t i) {
+                initialize_component(level[i], maxLoopIterations);
+            });
+        }
+    }
+
+    /// Removes everything from the plan.
+    void clear() noexcept;
+
+private:
+    using sim_to_sim_list =
+        transfer_list<simulator, variable_slot, simulator, variable_slot>;
+    using sim_to_fun_list =
+        transfer_list<simulator, variable_slot, function, function_io_reference>;
+    using fun_to_sim_list =
+        transfer_list<function, function_io_reference, simulator, variable_slot>;
+
+    struct function_phase
+    {
+        std::int64_t period = 1;
+        sim_to_fun_list fromSimulators;
+    };
+
+    // A function's calculation and the transfers to it.
+    struct function_group
+    {
+        function* fun = nullptr;
+        std::int64_t period = 1;
+        std::vector<function_phase> phases;
+
+        // Pipeline dependencies and dependents
+        std::vector<simulator*> sourceSimulators;
+        std::vector<std::size_t> dependentSimulatorGroups;
+    };
+
+    struct simulator_phase
+    {
+        std::int64_t period = 1;
+        sim_to_sim_list fromSimulators;
+        fun_to_sim_list fromFunctions;
+    };
+
+    // The transfers to one simulator.
+    struct simulator_group
+    {
+        simulator* target = nullptr;
+        std::vector<simulator_phase> phases;
+
+        // Pipeline dependencies (the target itself is always included)
+        std::vector<simulator*> sourceSimulators;
+        std::vector<std::size_t> sourceFunctionGroups;
+
+        // Whether any of the target's outputs are connected to its inputs
+        bool selfConnected = false;
+    };
+
+    // The groups that depend on a simulator.
+    struct simulator_dependents
+    {
+        std::vector<std::size_t> functionGroups;
+        std::vector<std::size_t> simulatorGroups;
+    };
+
+    // A simulator, or a function group, in the initialisation graph
+    struct init_node
+    {
+        simulator* sim = nullptr;
+        const simulator_group* simulatorGroup = nullptr;
+        const function_group* functionGroup = nullptr;
+    };
+
+    // A strongly connected component of the initialisation graph.  It is a
+    // loop if it has more than one node, or a single self-connected simulator.
+    struct init_component
+    {
+        std::vector<init_node> nodes;
+        bool loop = false;
+    };
+
+    // Returns the components of the initialisation graph, grouped in levels
+    // such that each component only depends on components in earlier levels.
+    std::vector<std::vector<init_component>> initialization_levels(
+        const std::vector<simulator*>& simulators) const;
+
+    void initialize_component(const init_component& component, std::size_t maxIterations) const;
+    bool initialize_node(const init_node& node, std::vector<scalar_value>* values) const;
+
+    void execute(const function_group& group, std::int64_t n) const;
+    void execute(const simulator_group& group, std::int64_t n) const;
+
+    std::size_t function_group_index(function* fun) const;
+    std::size_t simulator_group_index(simulator* target);
+    void add_function_group_source(std::size_t functionGroup, simulator* source);
+    void add_simulator_group_source(std::size_t simulatorGroup, simulator* source);
+    void add_simulator_group_source_function(std::size_t simulatorGroup, std::size_t functionGroup);
+
+    void function_group_ready(std::size_t index);
+    void simulator_group_ready(std::size_t index);
+
+    std::vector<function_group> functionGroups_;
+    std::vector<simulator_group> simulatorGroups_;
+    std::unordered_map<simulator*, simulator_dependents> simulatorDependents_;
+
+    // Pipelined execution state: the current base step number, the
+    // number of unfinished dependencies of each group, and the time spent
+    // executing groups (if measured).
+    std::int64_t pipelineStep_ = 0;
+    std::vector<std::atomic<std::size_t>> functionGroupsPending_;
+    std::vector<std::atomic<std::size_t>> simulatorGroupsPending_;
+    bool pipelineTimed_ = false;
+    std::atomic<duration::rep> pipelineFunctionTime_ = 0;
+    std::atomic<duration::rep> pipelineTransferTime_ = 0;
+};
+
+
+/**
+ *  Compiles an algorithm's connection graph into `plan`, replacing its
+ *  previous contents.
+ *
+ *  `simulators` and `functions` map indexes to the algorithm's bookkeeping
+ *  structures for simulators and functions, which must have the members
+ *  `sim` and `fun`, respectively, and lists of outgoing connections named
+ *  `outgoingSimConnections` and (for simulators) `outgoingFunConnections`.
+ *  `decimationFactor(info)` must return the decimation factor of either kind
+ *  of structure.
+ *
+ *  A connection is included in the transfers after base step `n` if `n` is
+ *  a multiple of the least common multiple of its endpoints' decimation
+ *  factors.  The source variables are re-exposed with that period, since
+ *  the decimation factors may have changed after the connections were made,
+ *  so that the simulators only retrieve them after the steps at which they
+ *  are transferred.
+ */
+template<typename SimulatorMap, typename FunctionMap, typename DecimationFactor>
+void compile_transfer_plan(
+    transfer_plan& plan,
+    const SimulatorMap& simulators,
+    const FunctionMap& functions,
+    DecimationFactor&& decimationFactor)
+{
+    plan.clear();
+    for (const auto& [idx, info] : functions) {
+        const std::int64_t factor = decimationFactor(info);
+        plan.add_function(factor, info.fun);
+        for (const auto& c : info.outgoingSimConnections) {
+            assert(c.source.type == c.target.type);
+            const auto& target = simulators.at(c.target.simulator);
+            plan.add_transfer(
+                std::lcm<std::int64_t>(factor, decimationFactor(target)),
+                c.target.type,
+                info.fun,
+                c.source.reference,
+                target.sim,
+                c.targetSlot);
+        }
+    }
+    for (const auto& [idx, info] : simulators) {
+        const std::int64_t factor = decimationFactor(info);
+        for (const auto& c : info.outgoingSimConnections) {
+            assert(c.source.type == c.target.type);
+            const auto& target = simulators.at(c.target.simulator);
+            const auto period = std::lcm<std::int64_t>(factor, decimationFactor(target));
+            info.sim->expose_for_periodic_getting(c.source.type, c.source.reference, period);
+            plan.add_transfer(
+                period,
+                c.target.type,
+                info.sim,
+                c.sourceSlot,
+                target.sim,
+                c.targetSlot);
+        }
+        for (const auto& c : info.outgoingFunConnections) {
+            assert(c.source.type == c.target.type);
+            const auto& target = functions.at(c.target.function);
+            const auto period = std::lcm<std::int64_t>(factor, decimationFactor(target));
+            info.sim->expose_for_periodic_getting(c.source.type, c.source.reference, period);
+            plan.add_transfer(
+                period,
+                c.target.type,
+                info.sim,
+                c.sourceSlot,
+                target.fun,
+                c.target.reference);
+        }
+    }
+}
+
+
+} // namespace detail
+} // namespace cosim
+#endif // COSIM_ALGORITHM_TRANSFER_PLAN_HPP
@@ -0,0 +1,98 @@
+/**
+ *  \file
+ *  The worker pool shared by the co-simulation algorithms.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_ALGORITHM_WORKER_POOL_HPP
+#define COSIM_ALGORITHM_WORKER_POOL_HPP
+
+#include "cosim/utility/fork_join_pool.hpp"
+#include "cosim/utility/thread_pool.hpp"
+
+#include <cosim/algorithm/algorithm.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace cosim
+{
+namespace detail
+{
+
+/**
+ *  A pool of worker threads of the type selected by `worker_pool_type`,
+ *  on which an algorithm runs its per-simulator and per-transfer tasks.
+ */
+class worker_pool
+{
+public:
+    /// Creates a pool with `threadCount` worker threads of the given type.
+    worker_pool(unsigned int threadCount, worker_pool_type type)
+    {
+        if (type == worker_pool_type::fork_join) {
+            forkJoinPool_ = std::make_unique<utility::fork_join_pool>(threadCount);
+        } else {
+            pool_ = std::make_unique<utility::thread_pool>(threadCount);
+        }
+    }
+
+    /**
+     *  Calls `f(i)` for every `i` in the range `[0, count)`, in parallel,
+     *  and waits for all calls to finish.  If any of the calls throw, the
+     *  first exception is rethrown afterwards.
+     */
+    template<typename F>
+    void parallel_for(std::size_t count, F&& f)
+    {
+        if (forkJoinPool_) {
+            forkJoinPool_->run(count, f);
+        } else {
+            std::exception_ptr error;
+            std::mutex errorMutex;
+            for (std::size_t i = 0; i < count; ++i) {
+                pool_->submit([&, i] {
+                    try {
+                        f(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (!error) error = std::current_exception();
+                    }
+                });
+            }
+            pool_->wait_for_tasks_to_finish();
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     *  Calls `f(*item)` for every element of `items`, as for `parallel_for()`.
+     *
+     *  With the fork/join pool, each element is always handled by the same
+     *  thread, as long as its position in `items` doesn't change.
+     */
+    template<typename T, typename F>
+    void for_each(const std::vector<T*>& items, F&& f)
+    {
+        parallel_for(items.size(), [&](std::size_t i) {
+            f(*items[i]);
+        });
+    }
+
+private:
+    // Only one of these is used, depending on the worker pool type.
+    std::unique_ptr<utility::thread_pool> pool_;
+    std::unique_ptr<utility::fork_join_pool> forkJoinPool_;
+};
+
+
+} // namespace detail
+} // namespace cosim
+#endif // COSIM_ALGORITHM_WORKER_POOL_HPP
@@ -9,10 +9,13 @@
 #include "cosim/error.hpp"
 #include "cosim/exception.hpp"
 #include "cosim/slave_simulator.hpp"
+#include "cosim/step_timer.hpp"
+#include "cosim/utility/binary_stream.hpp"
 #include "cosim/utility/utility.hpp"
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <sstream>
 #include <unordered_map>
 #include <utility>
@@ -32,8 +35,10 @@ public:
         , stopped_(true)
         , algorithm_(std::move(algo))
         , timer_()
+        , stepMetrics_(std::make_shared<step_metrics>())
     {
         algorithm_->setup(currentTime_, std::nullopt);
+        algorithm_->set_step_metrics(stepMetrics_);
     }
 
     ~impl() noexcept = default;
@@ -51,7 +56,10 @@ public:
     {
         COSIM_PRECONDITION(!initialized_);
         const auto index = static_cast<simulator_index>(simulators_.size());
-        simulators_.push_back(std::make_unique<slave_simulator>(slave, name));
+        auto sim = std::make_unique<slave_simulator>(slave, name);
+        sim->set_step_metrics(stepMetrics_, &stepMetrics_->add_simulator());
+        variableLookups_.emplace_back(sim->model_description());
+        simulators_.push_back(std::move(sim));
         algorithm_->add_simulator(index, simulators_.back().get(), stepSizeHint);
 
         for (const auto& obs : observers_) {
@@ -137,17 +145,29 @@ public:
     duration step()
     {
         initialize(); // For backwards compatibility. Should be replaced with a precondition check at some point.
-        for (const auto& man : manipulators_) {
-            man->step_commencing(currentTime_);
+        const auto metrics = stepMetrics_.get();
+        {
+            const auto timer = detail::step_timer(metrics, &step_metrics::manipulators);
+            for (const auto& man : manipulators_) {
+                man->step_commencing(currentTime_);
+            }
         }
-        const auto [stepSize, finished] = algorithm_->do_step(currentTime_);
+        std::pair<duration, std::unordered_set<simulator_index>> stepResult;
+        {
+            const auto timer = detail::step_timer(metrics, &step_metrics::step);
+            stepResult = algorithm_->do_step(currentTime_);
+        }
+        const auto& [stepSize, finished] = stepResult;
         currentTime_ += stepSize;
         ++lastStep_;
-        for (const auto& obs : observers_) {
-            for (const auto& index : finished) {
-                obs->simulator_step_complete(index, lastStep_, stepSize, currentTime_);
+        {
+            const auto timer = detail::step_timer(metrics, &step_metrics::observers);
+            for (const auto& obs : observers_) {
+                for (const auto& index : finished) {
+                    obs->simulator_step_complete(index, lastStep_, stepSize, currentTime_);
+                }
+                obs->step_complete(lastStep_, stepSize, currentTime_);
             }
-            obs->step_complete(lastStep_, stepSize, currentTime_);
         }
         return stepSize;
     }
@@ -188,7 +208,17 @@ public:
         return timer_.get_real_time_metrics();
     }
 
-    model_description get_model_description(simulator_index index) const
+    void enable_step_metrics(bool enable)
+    {
+        stepMetrics_->set_enabled(enable);
+    }
+
+    std::shared_ptr<const step_metrics> get_step_metrics() const
+    {
+        return stepMetrics_;
+    }
+
+    std::shared_ptr<const model_description> get_model_description(simulator_index index) const
     {
         return simulators_.at(index)->model_description();
     }
@@ -318,6 +348,85 @@ public:
         }
     }
 
+    // The binary format uses the platform's native representation, so it
+    // starts with a byte-order marker in addition to the magic number and
+    // version.  Simulators are identified by their position and name.
+    static constexpr char binary_state_magic[] = "COSIMSTA";
+    static constexpr std::uint32_t binary_state_version = 0;
+    static constexpr std::uint32_t binary_state_byte_order = 0x01020304;
+
+    void export_current_state(std::ostream& out) const
+    {
+        COSIM_PRECONDITION(initialized_ && !is_running());
+        auto binaryOut = utility::binary_output(out);
+        binaryOut.write_magic(binary_state_magic);
+        binaryOut.write(binary_state_version);
+        binaryOut.write(binary_state_byte_order);
+        binaryOut.write(lastStep_);
+        binaryOut.write<std::int64_t>(currentTime_.time_since_epoch().count());
+        serialization::write_binary(out, algorithm_->export_current_state());
+        binaryOut.write(static_cast<std::uint64_t>(simulators_.size()));
+        for (const auto& sim : simulators_) {
+            binaryOut.write_string(sim->name());
+            const auto savedStateIndex = sim->save_state();
+            sim->export_state_binary(savedStateIndex, out);
+            sim->release_state(savedStateIndex);
+        }
+        if (!out) {
+            throw error(
+                make_error_code(std::errc::io_error),
+                "Failed to write the execution state");
+        }
+    }
+
+    void import_state(std::istream& in)
+    {
+        COSIM_PRECONDITION(initialized_ && !is_running());
+        try {
+            auto binaryIn = utility::binary_input(in);
+            if (!binaryIn.read_magic(binary_state_magic) ||
+                binaryIn.read<std::uint32_t>() != binary_state_version ||
+                binaryIn.read<std::uint32_t>() != binary_state_byte_order) {
+                throw error(
+                    make_error_code(errc::bad_file),
+                    "The serialized execution state has an unknown format or was written on an incompatible platform");
+            }
+            const auto lastStep = binaryIn.read<step_number>();
+            const auto currentTime = time_point(duration(binaryIn.read<std::int64_t>()));
+            const auto algorithmState = serialization::read_binary(in);
+            if (binaryIn.read<std::uint64_t>() != simulators_.size()) {
+                throw error(
+                    make_error_code(errc::bad_file),
+                    "The serialized execution state has the wrong number of simulators");
+            }
+            for (const auto& sim : simulators_) {
+                if (binaryIn.read_string() != sim->name()) {
+                    throw error(
+                        make_error_code(errc::bad_file),
+                        "The serialized execution state does not contain the state of simulator '"
+                            + sim->name() + "' at the expected position");
+                }
+                const auto savedStateIndex = sim->import_state_binary(in);
+                sim->restore_state(savedStateIndex);
+                sim->release_state(savedStateIndex);
+            }
+            algorithm_->import_state(algorithmState);
+            lastStep_ = lastStep;
+            currentTime_ = currentTime;
+        } catch (const error&) {
+            throw;
+        } catch (...) {
+            throw error(
+                make_error_code(errc::bad_file),
+                "The serialized execution state is invalid or corrupt");
+        }
+
+        // Update observers
+        for (const auto& obs : observers_) {
+            obs->state_restored(lastStep_, currentTime_);
+        }
+    }
+
 private:
     template<typename OutputID, typename InputID>
     void connect_variables_impl(
@@ -337,12 +446,8 @@ private:
 
     void validate_variable(variable_id variable, variable_causality causality)
     {
-        const auto variables = simulators_.at(variable.simulator)->model_description().variables;
-        const auto it = std::find_if(
-            variables.begin(),
-            variables.end(),
-            [=](const auto& var) { return var.causality == causality && var.type == variable.type && var.reference == variable.reference; });
-        if (it == variables.end()) {
+        const auto& lookup = variableLookups_.at(variable.simulator);
+        if (!lookup.find(variable.type, variable.reference, causality)) {
             std::ostringstream oss;
             oss << "Problem adding connection: Cannot find variable with reference " << variable.reference
                 << ", causality " << cosim::to_text(causality)
@@ -379,6 +484,7 @@ private:
 
     std::shared_ptr<algorithm> algorithm_;
     std::vector<std::shared_ptr<simulator>> simulators_;
+    std::vector<variable_lookup> variableLookups_; // Parallel to `simulators_`
     std::vector<std::shared_ptr<function>> functions_;
     std::vector<std::shared_ptr<observer>> observers_;
     std::vector<std::shared_ptr<manipulator>> manipulators_;
@@ -386,6 +492,7 @@ private:
     std::unordered_map<function_io_id, variable_id> sfConnections_;
     std::unordered_map<variable_id, function_io_id> fsConnections_;
     real_time_timer timer_;
+    std::shared_ptr<step_metrics> stepMetrics_;
 };
 
 
@@ -481,7 +588,17 @@ std::shared_ptr<const real_time_metrics> execution::get_real_time_metrics() cons
     return pimpl_->get_real_time_metrics();
 }
 
-model_description execution::get_model_description(simulator_index index) const
+void execution::enable_step_metrics(bool enable)
+{
+    pimpl_->enable_step_metrics(enable);
+}
+
+std::shared_ptr<const step_metrics> execution::get_step_metrics() const
+{
+    return pimpl_->get_step_metrics();
+}
+
+std::shared_ptr<const model_description> execution::get_model_description(simulator_index index) const
 {
     return pimpl_->get_model_description(index);
 }
@@ -526,6 +643,16 @@ void execution::import_state(const serialization::node& exportedState)
     pimpl_->import_state(exportedState);
 }
 
+void execution::export_current_state(std::ostream& out) const
+{
+    pimpl_->export_current_state(out);
+}
+
+void execution::import_state(std::istream& in)
+{
+    pimpl_->import_state(in);
+}
+
 
 namespace
 {
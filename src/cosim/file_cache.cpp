@@ -10,6 +10,11 @@
 #include "cosim/utility/concurrency.hpp"
 #include "cosim/utility/filesystem.hpp"
 
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -79,6 +84,7 @@ public:
 
     std::unique_ptr<directory_rw> get_directory_rw(std::string_view key)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         auto& owns = get_ownership(std::string(key), true);
         if (owns.rw.use_count() + owns.ro.use_count() > 0) {
             throw std::logic_error(
@@ -94,6 +100,7 @@ public:
 
     std::unique_ptr<directory_ro> get_directory_ro(std::string_view key)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         auto& owns = get_ownership(std::string(key), false);
         if (owns.rw.use_count() > 0) {
             throw std::logic_error(
@@ -127,6 +134,7 @@ private:
     }
 
     std::shared_ptr<utility::temp_dir> root_;
+    std::mutex mutex_;
     std::unordered_map<std::string, subdirectory_ownership> ownerships_;
 };
 
@@ -225,12 +233,58 @@ public:
         }
     }
 
+    std::optional<std::string> get_index_entry(std::string_view key)
+    {
+        auto rootLock = utility::file_lock(
+            root_lock_file_path(),
+            utility::file_lock_initial_state::locked_shared);
+        auto file = std::ifstream(index_entry_path(key));
+        std::string line;
+        if (!std::getline(file, line)) return std::nullopt;
+        const auto space = line.find(' ');
+        if (space == std::string::npos) return std::nullopt;
+
+        // Entries whose keys hash to the same file replace each other, so
+        // the file must hold the entry for this particular key.
+        if (percent_decode(std::string_view(line).substr(0, space)) != key) {
+            return std::nullopt;
+        }
+        return percent_decode(std::string_view(line).substr(space + 1));
+    }
+
+    void set_index_entry(std::string_view key, std::string_view value)
+    {
+        auto rootLock = utility::file_lock(
+            root_lock_file_path(),
+            utility::file_lock_initial_state::locked);
+        cosim::filesystem::create_directories(index_dir_path());
+
+        // Write to a temporary file and rename it, so that an interrupted
+        // write doesn't leave a corrupt entry behind.
+        const auto path = index_entry_path(key);
+        auto tempPath = path;
+        tempPath += ".tmp";
+        {
+            auto file = std::ofstream(tempPath, std::ios_base::trunc);
+            file << percent_encode(key) << ' ' << percent_encode(value) << '\n';
+            if (!file) {
+                throw std::runtime_error(
+                    "Failed to write cache index file: " + tempPath.string());
+            }
+        }
+        cosim::filesystem::rename(tempPath, path);
+    }
+
     void cleanup()
     {
         auto rootLock = utility::file_lock(
             root_lock_file_path(),
             utility::file_lock_initial_state::locked);
 
+        // The index may refer to the subdirectories that are removed below.
+        std::error_code ignoredIndexError;
+        cosim::filesystem::remove_all(index_dir_path(), ignoredIndexError);
+
         for (auto it = cosim::filesystem::directory_iterator(root_);
              it != cosim::filesystem::directory_iterator();
              ++it) {
@@ -274,6 +328,26 @@ private:
         return root_ / "lock";
     }
 
+    cosim::filesystem::path index_dir_path() const
+    {
+        return root_ / "index.d";
+    }
+
+    // Returns the path to the file which holds the index entry for `key`,
+    // whose name is a 64-bit FNV-1a hash of the key.  Each file contains a
+    // single line with the percent-encoded key and value.
+    cosim::filesystem::path index_entry_path(std::string_view key) const
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const char c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        std::ostringstream name;
+        name << std::hex << std::setfill('0') << std::setw(16) << hash;
+        return index_dir_path() / name.str();
+    }
+
     cosim::filesystem::path subdir_path(std::string_view key) const
     {
         auto p = root_;
@@ -318,6 +392,18 @@ std::unique_ptr<file_cache::directory_ro> persistent_file_cache::get_directory_r
 }
 
 
+std::optional<std::string> persistent_file_cache::get_index_entry(std::string_view key)
+{
+    return impl_->get_index_entry(key);
+}
+
+
+void persistent_file_cache::set_index_entry(std::string_view key, std::string_view value)
+{
+    impl_->set_index_entry(key, value);
+}
+
+
 void persistent_file_cache::cleanup()
 {
     impl_->cleanup();
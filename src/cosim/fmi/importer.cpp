@@ -18,9 +18,20 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <gsl/util>
 
+#include <algorithm>
+#include <cassert>
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 
 namespace cosim
@@ -155,71 +166,215 @@ bool is_outdated(
         cosim::filesystem::last_write_time(comparator) > cosim::filesystem::last_write_time(file);
 }
 
-} // namespace
-
+// The name of the subdirectory of an FMU's `binaries` directory which holds
+// the binaries for the current platform.
+constexpr std::string_view fmu_platform_name =
+#if defined(_WIN32)
+    sizeof(void*) == 8 ? "win64" : "win32";
+#elif defined(__APPLE__)
+    sizeof(void*) == 8 ? "darwin64" : "darwin32";
+#else
+    sizeof(void*) == 8 ? "linux64" : "linux32";
+#endif
+
+// Returns whether an FMU archive entry is needed to load and run the FMU on
+// this platform.  These are the model description, the binaries for the
+// current platform, and the resources, which the model code may read at any
+// time after instantiation.  Binaries for other platforms, sources,
+// documentation and so on are never used by us.
+bool is_runtime_entry(std::string_view entryName)
+{
+    const auto startsWith = [entryName](std::string_view prefix) {
+        return entryName.substr(0, prefix.size()) == prefix;
+    };
+    constexpr std::string_view binariesDir = "binaries/";
+    return entryName == "modelDescription.xml" ||
+        startsWith("resources/") ||
+        (startsWith(binariesDir) &&
+            entryName.substr(binariesDir.size(), fmu_platform_name.size()) == fmu_platform_name &&
+            entryName.substr(binariesDir.size() + fmu_platform_name.size(), 1) == "/");
+}
 
-std::shared_ptr<fmu> importer::import(const cosim::filesystem::path& fmuPath)
+// Computes a hash of a file's contents (64-bit FNV-1a, followed by the file
+// size), for use as an identifier in the file cache index.
+std::string hash_file_contents(const cosim::filesystem::path& path)
 {
-    prune_ptr_caches();
-    auto pit = pathCache_.find(fmuPath);
-    if (pit != end(pathCache_)) return pit->second.lock();
-
-    // Unzip the model description into a temporary folder
-    const auto tempMdDir = utility::temp_dir();
-    const auto zip = cosim::utility::zip::archive(fmuPath);
-    const auto modelDescriptionIndex = zip.find_entry("modelDescription.xml");
-    if (modelDescriptionIndex == cosim::utility::zip::invalid_entry_index) {
+    auto file = std::ifstream(path, std::ios_base::binary);
+    if (!file) {
         throw error(
             make_error_code(errc::bad_file),
-            fmuPath.string() + " does not contain modelDescription.xml");
+            "Failed to open file: " + path.string());
     }
-    zip.extract_file_to(modelDescriptionIndex, tempMdDir.path());
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::uint64_t size = 0;
+    std::vector<char> buffer(1 << 16);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto count = static_cast<std::size_t>(file.gcount());
+        for (std::size_t i = 0; i < count; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+        size += count;
+    }
+    std::ostringstream result;
+    result << std::hex << std::setfill('0') << std::setw(16) << hash << '-' << std::dec << size;
+    return result.str();
+}
 
-    // Look at the model description to figure out the FMU's GUID.
-    const auto minModelDesc = peek_model_description(tempMdDir.path());
-    if (minModelDesc.fmiVersion == fmi_version::unknown) {
-        throw error(
-            make_error_code(errc::unsupported_feature),
-            "Unsupported FMI version for FMU '" + fmuPath.string() + "'");
+// Returns the content hash of an FMU file.  The hash is recorded in the
+// cache index along with the file's size and modification time, and only
+// recomputed if either of them has changed.
+std::string fmu_content_hash(file_cache& cache, const cosim::filesystem::path& fmuPath)
+{
+    const auto absolutePath = cosim::filesystem::absolute(fmuPath);
+    std::ostringstream stamp;
+    stamp << cosim::filesystem::file_size(absolutePath) << ' '
+          << cosim::filesystem::last_write_time(absolutePath).time_since_epoch().count() << ' ';
+    const auto fileKey = "fmu-file:" + absolutePath.string();
+    if (const auto entry = cache.get_index_entry(fileKey)) {
+        if (entry->compare(0, stamp.str().size(), stamp.str()) == 0) {
+            return entry->substr(stamp.str().size());
+        }
     }
+    const auto hash = hash_file_contents(absolutePath);
+    cache.set_index_entry(fileKey, stamp.str() + hash);
+    return hash;
+}
 
-    // If we have already loaded this FMU, return our existing instance.
-    auto git = guidCache_.find(minModelDesc.guid);
-    if (git != end(guidCache_)) return git->second.lock();
-
-    // Get a cache directory to hold the entire FMU contents.
-
-    std::string guidStr = std::string(minModelDesc.guid);
-    guidStr.erase(std::remove(guidStr.begin(), guidStr.end(), '{'), guidStr.end());
-    guidStr.erase(std::remove(guidStr.begin(), guidStr.end(), '}'), guidStr.end());
-
-    auto fmuUnpackDir = fileCache_->get_directory_rw(guidStr);
-
-    // Unzip the entire FMU if necessary.
-    const auto modelDescriptionPath = fmuUnpackDir->path() / "modelDescription.xml";
-    if (is_outdated(modelDescriptionPath, fmuPath)) {
-        try {
-            zip.extract_all(fmuUnpackDir->path());
-        } catch (...) {
-            // Remove model description again, so we don't erroneously think
-            // that the unpacking was successful the next time we try it.
-            std::error_code ignoredError;
-            cosim::filesystem::remove(modelDescriptionPath, ignoredError);
-            throw;
+// Looks up the FMI version and GUID of the FMU with the given content hash
+// in the cache index.
+std::optional<minimal_model_description> find_indexed_model_description(
+    file_cache& cache,
+    const std::string& contentHash)
+{
+    const auto entry = cache.get_index_entry("fmu-content:" + contentHash);
+    if (!entry) return std::nullopt;
+    std::istringstream fields(*entry);
+    int version = 0;
+    minimal_model_description md;
+    if (!(fields >> version) || !std::getline(fields >> std::ws, md.guid) || md.guid.empty()) {
+        return std::nullopt;
+    }
+    md.fmiVersion = static_cast<fmi_version>(version);
+    return md;
+}
+
+} // namespace
+
+
+std::shared_ptr<fmu> importer::import(
+    const cosim::filesystem::path& fmuPath,
+    unsigned int maxThreads)
+{
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        prune_ptr_caches();
+        auto pit = pathCache_.find(fmuPath);
+        if (pit != end(pathCache_)) {
+            if (auto fmuObj = pit->second.lock()) return fmuObj;
         }
     }
 
-    // Drop R/W privileges and acquire read-only access to FMU cache directory
-    fmuUnpackDir.reset();
-    auto fmuUnpackDirRO = fileCache_->get_directory_ro(guidStr);
-
-    // Create and return an `fmu` object.
-    auto fmuObj = minModelDesc.fmiVersion == fmi_version::v1_0
-        ? std::shared_ptr<fmu>(new v1::fmu(shared_from_this(), std::move(fmuUnpackDirRO)))
-        : std::shared_ptr<fmu>(new v2::fmu(shared_from_this(), std::move(fmuUnpackDirRO)));
-    pathCache_[fmuPath] = fmuObj;
-    guidCache_[minModelDesc.guid] = fmuObj;
-    return fmuObj;
+    // If the cache has an index, identify the FMU by its contents, and see
+    // if we have seen it before.  In that case, we already know its GUID,
+    // and may not need to open it at all.
+    std::optional<std::string> contentHash;
+    std::optional<minimal_model_description> minModelDesc;
+    if (fileCache_->has_index()) {
+        contentHash = fmu_content_hash(*fileCache_, fmuPath);
+        minModelDesc = find_indexed_model_description(*fileCache_, *contentHash);
+    }
+
+    std::optional<cosim::utility::zip::archive> zip;
+    if (!minModelDesc) {
+        // Unzip the model description into a temporary folder
+        const auto tempMdDir = utility::temp_dir();
+        zip.emplace(fmuPath);
+        const auto modelDescriptionIndex = zip->find_entry("modelDescription.xml");
+        if (modelDescriptionIndex == cosim::utility::zip::invalid_entry_index) {
+            throw error(
+                make_error_code(errc::bad_file),
+                fmuPath.string() + " does not contain modelDescription.xml");
+        }
+        zip->extract_file_to(modelDescriptionIndex, tempMdDir.path());
+
+        // Look at the model description to figure out the FMU's GUID.
+        minModelDesc = peek_model_description(tempMdDir.path());
+        if (minModelDesc->fmiVersion == fmi_version::unknown) {
+            throw error(
+                make_error_code(errc::unsupported_feature),
+                "Unsupported FMI version for FMU '" + fmuPath.string() + "'");
+        }
+        if (contentHash) {
+            fileCache_->set_index_entry(
+                "fmu-content:" + *contentHash,
+                std::to_string(static_cast<int>(minModelDesc->fmiVersion)) + ' ' + minModelDesc->guid);
+        }
+    }
+
+    // If we have already loaded this FMU, or another thread is loading it,
+    // return that instance.
+    if (auto existing = find_or_begin_import(minModelDesc->guid)) {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        pathCache_[fmuPath] = existing;
+        return existing;
+    }
+
+    try {
+        // Get a cache directory to hold the entire FMU contents.
+
+        std::string guidStr = std::string(minModelDesc->guid);
+        guidStr.erase(std::remove(guidStr.begin(), guidStr.end(), '{'), guidStr.end());
+        guidStr.erase(std::remove(guidStr.begin(), guidStr.end(), '}'), guidStr.end());
+
+        // The index is guarded by the cache root lock, which must never be
+        // acquired while holding a subdirectory lock (the cache itself takes
+        // them in the opposite order).  Therefore, we read the index entry
+        // before locking the directory, and update it after releasing it.
+        const auto unpackedKey = "fmu-unpacked:" + guidStr;
+        const auto unpackedHash = contentHash
+            ? fileCache_->get_index_entry(unpackedKey)
+            : std::nullopt;
+
+        auto fmuUnpackDir = fileCache_->get_directory_rw(guidStr);
+
+        // Unzip the parts of the FMU we need, if necessary.  If the index records which
+        // FMU contents were unpacked to the directory, that decides it,
+        // otherwise we compare modification times.
+        const auto modelDescriptionPath = fmuUnpackDir->path() / "modelDescription.xml";
+        const bool upToDate = unpackedHash
+            ? (*unpackedHash == *contentHash && cosim::filesystem::exists(modelDescriptionPath))
+            : !is_outdated(modelDescriptionPath, fmuPath);
+        if (!upToDate) {
+            try {
+                if (!zip) zip.emplace(fmuPath);
+                zip->extract_matching(
+                    fmuUnpackDir->path(),
+                    is_runtime_entry,
+                    std::max(maxThreads, 1u));
+            } catch (...) {
+                // Remove model description again, so we don't erroneously think
+                // that the unpacking was successful the next time we try it.
+                std::error_code ignoredError;
+                cosim::filesystem::remove(modelDescriptionPath, ignoredError);
+                throw;
+            }
+        }
+
+        // Drop R/W privileges and acquire read-only access to FMU cache directory
+        fmuUnpackDir.reset();
+        if (!upToDate && contentHash) fileCache_->set_index_entry(unpackedKey, *contentHash);
+        auto fmuUnpackDirRO = fileCache_->get_directory_ro(guidStr);
+
+        // Create and return an `fmu` object.
+        auto fmuObj = load_unpacked(minModelDesc->fmiVersion, std::move(fmuUnpackDirRO));
+        finish_import(minModelDesc->guid, &fmuPath, fmuObj, nullptr);
+        return fmuObj;
+    } catch (...) {
+        finish_import(minModelDesc->guid, nullptr, nullptr, std::current_exception());
+        throw;
+    }
 }
 
 
@@ -243,22 +398,75 @@ private:
 std::shared_ptr<fmu> importer::import_unpacked(
     const cosim::filesystem::path& unpackedFMUPath)
 {
-    prune_ptr_caches();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        prune_ptr_caches();
+    }
     const auto minModelDesc = peek_model_description(unpackedFMUPath);
     if (minModelDesc.fmiVersion == fmi_version::unknown) {
         throw error(
             make_error_code(errc::unsupported_feature),
             "Unsupported FMI version for FMU at '" + unpackedFMUPath.string() + "'");
     }
-    auto git = guidCache_.find(minModelDesc.guid);
-    if (git != end(guidCache_)) return git->second.lock();
-
-    auto unpackedFMUDir = std::make_unique<existing_directory_ro>(unpackedFMUPath);
-    auto fmuObj = minModelDesc.fmiVersion == fmi_version::v1_0
-        ? std::shared_ptr<fmu>(new v1::fmu(shared_from_this(), std::move(unpackedFMUDir)))
-        : std::shared_ptr<fmu>(new v2::fmu(shared_from_this(), std::move(unpackedFMUDir)));
-    guidCache_[minModelDesc.guid] = fmuObj;
-    return fmuObj;
+    if (auto existing = find_or_begin_import(minModelDesc.guid)) return existing;
+
+    try {
+        auto fmuObj = load_unpacked(
+            minModelDesc.fmiVersion,
+            std::make_unique<existing_directory_ro>(unpackedFMUPath));
+        finish_import(minModelDesc.guid, nullptr, fmuObj, nullptr);
+        return fmuObj;
+    } catch (...) {
+        finish_import(minModelDesc.guid, nullptr, nullptr, std::current_exception());
+        throw;
+    }
+}
+
+
+std::shared_ptr<fmu> importer::load_unpacked(
+    fmi_version version,
+    std::unique_ptr<file_cache::directory_ro> fmuDir)
+{
+    std::lock_guard<std::mutex> lock(fmilibMutex_);
+    return version == fmi_version::v1_0
+        ? std::shared_ptr<fmu>(new v1::fmu(shared_from_this(), std::move(fmuDir)))
+        : std::shared_ptr<fmu>(new v2::fmu(shared_from_this(), std::move(fmuDir)));
+}
+
+
+std::shared_ptr<fmu> importer::find_or_begin_import(const std::string& guid)
+{
+    std::unique_lock<std::mutex> lock(cacheMutex_);
+    if (const auto git = guidCache_.find(guid); git != end(guidCache_)) {
+        if (auto fmuObj = git->second.lock()) return fmuObj;
+    }
+    if (const auto pit = pendingImports_.find(guid); pit != end(pendingImports_)) {
+        const auto result = pit->second.result;
+        lock.unlock();
+        return result.get(); // Rethrows the other import's exception, if any
+    }
+    pendingImports_.try_emplace(guid);
+    return nullptr;
+}
+
+
+void importer::finish_import(
+    const std::string& guid,
+    const cosim::filesystem::path* fmuPath,
+    std::shared_ptr<fmu> fmuObj,
+    std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    const auto pit = pendingImports_.find(guid);
+    assert(pit != end(pendingImports_));
+    if (error) {
+        pit->second.promise.set_exception(error);
+    } else {
+        if (fmuPath) pathCache_[*fmuPath] = fmuObj;
+        guidCache_[guid] = fmuObj;
+        pit->second.promise.set_value(fmuObj);
+    }
+    pendingImports_.erase(pit);
 }
 
 
@@ -125,7 +125,7 @@ void override_manipulator::add_action(
         scenario::string_modifier>& m)
 {
     auto sim = simulators_.at(index);
-    auto causality = find_variable_causality(sim->model_description().variables, type, variable);
+    auto causality = find_variable_causality(sim->model_description()->variables, type, variable);
     bool input = is_input(causality);
 
     std::lock_guard<std::mutex> lock(lock_);
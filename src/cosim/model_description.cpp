@@ -5,7 +5,10 @@
  */
 #include "cosim/model_description.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
+#include <utility>
 
 
 namespace cosim
@@ -21,4 +24,63 @@ std::optional<variable_description> find_variable(const model_description& descr
     return std::nullopt;
 }
 
+
+variable_lookup::variable_lookup(std::shared_ptr<const model_description> description)
+    : description_(std::move(description))
+{
+    assert(description_);
+    const auto& variables = description_->variables;
+    byName_.reserve(variables.size());
+    byReference_.reserve(variables.size());
+    for (const auto& variable : variables) {
+        byName_.emplace(variable.name, &variable);
+        byReference_.push_back(&variable);
+    }
+
+    const auto key = [](const variable_description* v) {
+        return reference_key(v->type, v->reference);
+    };
+    std::stable_sort(
+        byReference_.begin(),
+        byReference_.end(),
+        [&](const auto* a, const auto* b) { return key(a) < key(b); });
+    for (std::size_t i = 0; i < byReference_.size();) {
+        const auto k = key(byReference_[i]);
+        auto j = i + 1;
+        while (j < byReference_.size() && key(byReference_[j]) == k) ++j;
+        referenceRanges_.emplace(k, reference_range{i, j});
+        i = j;
+    }
+}
+
+
+const variable_description* variable_lookup::find(std::string_view name) const
+{
+    const auto it = byName_.find(name);
+    return it == byName_.end() ? nullptr : it->second;
+}
+
+
+const variable_description* variable_lookup::find(
+    variable_type type,
+    value_reference reference) const
+{
+    const auto it = referenceRanges_.find(reference_key(type, reference));
+    return it == referenceRanges_.end() ? nullptr : byReference_[it->second.begin];
+}
+
+
+const variable_description* variable_lookup::find(
+    variable_type type,
+    value_reference reference,
+    variable_causality causality) const
+{
+    const auto it = referenceRanges_.find(reference_key(type, reference));
+    if (it == referenceRanges_.end()) return nullptr;
+    for (auto i = it->second.begin; i < it->second.end; ++i) {
+        if (byReference_[i]->causality == causality) return byReference_[i];
+    }
+    return nullptr;
+}
+
 } // namespace cosim
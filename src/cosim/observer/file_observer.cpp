@@ -7,17 +7,22 @@
 
 #include "cosim/error.hpp"
 #include "cosim/log/logger.hpp"
+#include "cosim/utility/binary_stream.hpp"
 
 #include <boost/date_time/local_time/local_time.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 
 #include <algorithm>
 #include <codecvt>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <locale>
-#include <map>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -47,9 +52,93 @@ void clear_file_contents_if_exists(const cosim::filesystem::path& filePath, std:
     }
 }
 
+const char* file_extension(file_observer_format format)
+{
+    return format == file_observer_format::binary ? ".bin" : ".csv";
+}
+
+
+// The values of the logged variables of one simulator at one step.
+struct log_sample
+{
+    step_number step = 0;
+    time_point time;
+    std::vector<double> reals;
+    std::vector<int> integers;
+    std::vector<bool> booleans;
+    std::vector<std::string> strings;
+};
+
+
+// A fixed-capacity FIFO queue of samples, used for asynchronous writing.
+// `head` and `tail` are the total numbers of samples that have been popped
+// and pushed, respectively.
+struct sample_ring
+{
+    std::vector<log_sample> slots;
+    std::size_t head = 0;
+    std::size_t tail = 0;
+};
+
 } // namespace
 
 
+// A background thread which writes the samples that are queued in the ring
+// buffers of a set of value writers.
+//
+// Only `head` and `tail` of the ring buffers are protected by the mutex.
+// The slot at `tail` is owned by the producer until it is pushed, and the
+// slots in the range [head, tail) are owned by the writer thread until they
+// are popped.
+class file_observer::async_writer
+{
+public:
+    explicit async_writer(file_observer_overflow_policy policy);
+    ~async_writer() noexcept;
+
+    async_writer(const async_writer&) = delete;
+    async_writer& operator=(const async_writer&) = delete;
+
+    void add(slave_value_writer* writer);
+
+    // Waits until all samples queued for `writer` have been written, and
+    // removes it.
+    void remove(slave_value_writer* writer);
+
+    // Returns the slot in which the next sample for `writer` should be
+    // stored, or null if the sample should be dropped.  The sample is
+    // queued by `end_push()`.  Rethrows any pending write error (see
+    // `rethrow_error()`).
+    log_sample* begin_push(slave_value_writer& writer);
+    void end_push(slave_value_writer& writer);
+
+    // Waits until all samples queued for `writer` have been written.
+    void drain(slave_value_writer& writer);
+
+    std::uint64_t dropped_count() const noexcept
+    {
+        return droppedCount_.load(std::memory_order_relaxed);
+    }
+
+    // Rethrows the first error which occurred on the writer thread since
+    // the last call, if any.
+    void rethrow_error();
+
+private:
+    void run();
+
+    const file_observer_overflow_policy policy_;
+    std::mutex mutex_;
+    std::condition_variable dataCv_;
+    std::condition_variable spaceCv_;
+    std::vector<slave_value_writer*> writers_;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::atomic<std::uint64_t> droppedCount_ = 0;
+    std::thread thread_;
+};
+
+
 class file_observer::slave_value_writer
 {
 public:
@@ -57,6 +146,7 @@ public:
         : observable_(observable)
         , logDir_(logDir)
         , timeStampedFileNames_(timeStampedFileNames)
+        , format_(file_observer_format::csv)
     {
         initialize_default();
     }
@@ -67,48 +157,73 @@ public:
         size_t decimationFactor,
         const std::vector<variable_description>& variables, 
         bool timeStampedFileNames = true,
-        const int precision = -1)
+        const int precision = -1,
+        file_observer_format format = file_observer_format::csv)
         : observable_(observable)
         , logDir_(logDir)
         , decimationFactor_(decimationFactor)
         , timeStampedFileNames_(timeStampedFileNames)
         , precision_(precision)
+        , format_(format)
     {
         initialize_config(variables);
     }
 
     void observe(step_number timeStep, time_point currentTime)
     {
+        if (asyncWriter_) {
+            std::lock_guard<std::mutex> lock(producerMutex_);
+            if (recording_ && timeStep % decimationFactor_ == 0) {
+                if (auto sample = asyncWriter_->begin_push(*this)) {
+                    read_sample(timeStep, currentTime, *sample);
+                    asyncWriter_->end_push(*this);
+                }
+            }
+            return;
+        }
+
         std::lock_guard<std::mutex> lock(mutex_);
         if (recording_) {
             if (!fsw_.is_open()) {
-                auto dataFileName = create_log_file();
-                create_metadata_file(dataFileName);
+                open_log_file();
             }
             if (timeStep % decimationFactor_ == 0) {
+                read_sample(timeStep, currentTime, sample_);
+                write_sample(sample_);
+            }
+        }
+    }
 
-                if (!realVars_.empty()) realSamples_[timeStep].reserve(realVars_.size());
-                if (!intVars_.empty()) intSamples_[timeStep].reserve(intVars_.size());
-                if (!boolVars_.empty()) boolSamples_[timeStep].reserve(boolVars_.size());
-                if (!stringVars_.empty()) stringSamples_[timeStep].reserve(stringVars_.size());
+    /**
+     *  Enables asynchronous writing, where `observe()` queues samples in a
+     *  ring buffer of the given size, to be written by `asyncWriter`.
+     */
+    void write_asynchronously(async_writer* asyncWriter, std::size_t bufferSize)
+    {
+        ring_.slots.resize(bufferSize, sample_);
+        asyncWriter_ = asyncWriter;
+        asyncWriter_->add(this);
+    }
 
-                for (const auto& vd : realVars_) {
-                    realSamples_[timeStep].push_back(observable_->get_real(vd.reference));
-                }
-                for (const auto& vd : intVars_) {
-                    intSamples_[timeStep].push_back(observable_->get_integer(vd.reference));
-                }
-                for (const auto& vd : boolVars_) {
-                    boolSamples_[timeStep].push_back(observable_->get_boolean(vd.reference));
-                }
-                for (const auto& vd : stringVars_) {
-                    stringSamples_[timeStep].push_back(observable_->get_string(vd.reference));
-                }
-                timeSamples_[timeStep] = to_double_time_point(currentTime);
+    sample_ring& ring() noexcept
+    {
+        return ring_;
+    }
 
-                persist();
-            }
+    // Writes a sample which was queued by `observe()`.
+    void write_queued_sample(const log_sample& sample)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!fsw_.is_open()) {
+            open_log_file();
         }
+        write_sample(sample);
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fsw_.is_open()) fsw_.flush();
     }
 
     void start_recording()
@@ -118,21 +233,30 @@ public:
 
     void stop_recording()
     {
+        {
+            std::lock_guard<std::mutex> lock(producerMutex_);
+            recording_ = false;
+        }
+        if (asyncWriter_) asyncWriter_->drain(*this);
+
         std::lock_guard<std::mutex> lock(mutex_);
         if (fsw_.is_open()) {
+            if (binaryOutput_) finish_binary_segment();
             fsw_.close();
         }
-        recording_ = false;
-        realSamples_.clear();
-        intSamples_.clear();
-        boolSamples_.clear();
-        stringSamples_.clear();
-        timeSamples_.clear();
     }
 
     ~slave_value_writer()
     {
         if (fsw_.is_open()) {
+            if (binaryOutput_) {
+                try {
+                    finish_binary_segment();
+                } catch (const std::exception& e) {
+                    BOOST_LOG_SEV(log::logger(), log::error)
+                        << "Failed to finish log file for " << observable_->name() << ": " << e.what();
+                }
+            }
             fsw_.close();
         }
     }
@@ -150,52 +274,107 @@ private:
 
     void initialize_variable(const variable_description& vd)
     {
-        observable_->expose_for_getting(vd.type, vd.reference);
+        // Values are only logged at multiples of the decimation factor, so
+        // the simulator need not retrieve them after other steps.
+        const auto slot = observable_->expose_for_periodic_getting(
+            vd.type,
+            vd.reference,
+            static_cast<step_number>(decimationFactor_));
 
         switch (vd.type) {
             case variable_type::real:
                 realVars_.push_back(vd);
+                realSlots_.push_back(slot);
                 break;
             case variable_type::integer:
                 intVars_.push_back(vd);
+                intSlots_.push_back(slot);
                 break;
             case variable_type::string:
                 stringVars_.push_back(vd);
+                stringSlots_.push_back(slot);
                 break;
             case variable_type::boolean:
                 boolVars_.push_back(vd);
+                boolSlots_.push_back(slot);
                 break;
             case variable_type::enumeration:
                 COSIM_PANIC();
         }
     }
 
+    // Sizes `sample_` so that `read_sample()` does not need to allocate
+    // (except for long strings).
+    void initialize_sample()
+    {
+        sample_.reals.resize(realVars_.size());
+        sample_.integers.resize(intVars_.size());
+        sample_.booleans.resize(boolVars_.size());
+        sample_.strings.resize(stringVars_.size());
+    }
+
+    void read_sample(step_number timeStep, time_point currentTime, log_sample& sample) const
+    {
+        sample.step = timeStep;
+        sample.time = currentTime;
+        for (std::size_t i = 0; i < realSlots_.size(); ++i) {
+            sample.reals[i] = observable_->get_real(realSlots_[i]);
+        }
+        for (std::size_t i = 0; i < intSlots_.size(); ++i) {
+            sample.integers[i] = observable_->get_integer(intSlots_[i]);
+        }
+        for (std::size_t i = 0; i < boolSlots_.size(); ++i) {
+            sample.booleans[i] = observable_->get_boolean(boolSlots_[i]);
+        }
+        for (std::size_t i = 0; i < stringSlots_.size(); ++i) {
+            sample.strings[i] = observable_->get_string(stringSlots_[i]);
+        }
+    }
+
+    void write_sample(const log_sample& sample)
+    {
+        if (format_ == file_observer_format::binary) {
+            append_binary_row(sample);
+        } else {
+            write_csv_row(sample);
+        }
+    }
+
+    void open_log_file()
+    {
+        auto dataFileName = create_log_file();
+        create_metadata_file(dataFileName);
+    }
+
     /** Default constructor initialization, all variables - except those with causality local - are logged. */
     void initialize_default()
     {
         if (!timeStampedFileNames_) {
-            const auto filePath = logDir_ / observable_->name().append(".csv");
+            const auto filePath = logDir_ / observable_->name().append(file_extension(format_));
             clear_file_contents_if_exists(filePath, fsw_);
         }
 
-        for (const auto& vd : observable_->model_description().variables) {
+        const auto md = observable_->model_description();
+        for (const auto& vd : md->variables) {
             if (vd.causality != variable_causality::local) {
                 initialize_variable(vd);
             }
         }
+        initialize_sample();
     }
 
     /** External config initialization, only configured variables are logged. */
     void initialize_config(const std::vector<variable_description>& variables)
     {
         if (!timeStampedFileNames_) {
-            const auto filePath = logDir_ / observable_->name().append(".csv");
+            const auto filePath = logDir_ / observable_->name().append(file_extension(format_));
             clear_file_contents_if_exists(filePath, fsw_);
         }
 
         for (const auto& vd : variables) {
             initialize_variable(vd);
         }
+        initialize_sample();
     }
 
     std::string create_log_file()
@@ -205,15 +384,19 @@ private:
         std::string time_str;
 
         if (!timeStampedFileNames_) {
-            filename = observable_->name().append(".csv");
+            filename = observable_->name().append(file_extension(format_));
         } else {
             time_str = format_time(boost::posix_time::microsec_clock::local_time());
-            filename = observable_->name().append("_").append(time_str).append(".csv");
+            filename = observable_->name().append("_").append(time_str).append(file_extension(format_));
         }
 
         const auto filePath = logDir_ / filename;
         cosim::filesystem::create_directories(logDir_);
-        fsw_.open(filePath, std::ios_base::out | std::ios_base::app);
+        if (format_ == file_observer_format::binary) {
+            fsw_.open(filePath, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+        } else {
+            fsw_.open(filePath, std::ios_base::out | std::ios_base::app);
+        }
 
         if (fsw_.fail()) {
             std::stringstream error;
@@ -221,6 +404,11 @@ private:
             throw std::runtime_error(error.str());
         }
 
+        if (format_ == file_observer_format::binary) {
+            start_binary_segment();
+            return time_str;
+        }
+
         ss << "Time,StepCount";
 
         // Add variable names
@@ -283,14 +471,14 @@ private:
             throw std::runtime_error(error.str());
         }
 
-        auto md = observable_->model_description();
+        const auto md = observable_->model_description();
 
         ss << std::left
-           << std::setw(keyWidth_) << "name:" << md.name << std::endl
-           << std::setw(keyWidth_) << "uuid:" << md.uuid << std::endl
-           << std::setw(keyWidth_) << "description:" << md.description << std::endl
-           << std::setw(keyWidth_) << "author:" << md.author << std::endl
-           << std::setw(keyWidth_) << "version:" << md.version << std::endl;
+           << std::setw(keyWidth_) << "name:" << md->name << std::endl
+           << std::setw(keyWidth_) << "uuid:" << md->uuid << std::endl
+           << std::setw(keyWidth_) << "description:" << md->description << std::endl
+           << std::setw(keyWidth_) << "author:" << md->author << std::endl
+           << std::setw(keyWidth_) << "version:" << md->version << std::endl;
 
         ss << "variables:" << std::endl;
 
@@ -305,50 +493,160 @@ private:
         metadata_fw.close();
     }
 
-    void persist()
+    // Writes the header of a new binary segment and prepares the column
+    // buffers.
+    void start_binary_segment()
     {
-        std::stringstream ss;
-        const auto defaultPrecision = ss.precision();
+        binaryOutput_ = std::make_unique<utility::binary_output>(fsw_);
+        blockIndex_.clear();
+
+        const auto md = observable_->model_description();
+        auto& out = *binaryOutput_;
+        out.write_magic("COSIMLOG");
+        out.write(std::uint32_t(1));
+        out.write(std::uint32_t(0x01020304));
+        out.write_string(observable_->name());
+        out.write_string(md->name);
+        out.write_string(md->uuid);
+        for (const auto vars : {&realVars_, &intVars_, &boolVars_, &stringVars_}) {
+            out.write(static_cast<std::uint32_t>(vars->size()));
+        }
+        for (const auto vars : {&realVars_, &intVars_, &boolVars_, &stringVars_}) {
+            for (const auto& vd : *vars) {
+                out.write_string(vd.name);
+                out.write(static_cast<std::uint32_t>(vd.reference));
+                out.write_string(to_text(vd.causality));
+                out.write_string(to_text(vd.variability));
+            }
+        }
 
-        if (fsw_.is_open()) {
+        // Aim for blocks of around 1 MiB (assuming 16 bytes per string),
+        // but with at least 16 and at most 1024 rows.
+        const auto rowSize = 2 * sizeof(std::int64_t)
+            + realVars_.size() * sizeof(double)
+            + intVars_.size() * sizeof(std::int32_t)
+            + boolVars_.size() * sizeof(std::uint8_t)
+            + stringVars_.size() * 16;
+        blockCapacity_ = std::clamp<std::size_t>((1 << 20) / rowSize, 16, 1024);
+        blockRows_ = 0;
+        stepColumn_.resize(blockCapacity_);
+        timeColumn_.resize(blockCapacity_);
+        realColumns_.resize(realVars_.size() * blockCapacity_);
+        intColumns_.resize(intVars_.size() * blockCapacity_);
+        boolColumns_.resize(boolVars_.size() * blockCapacity_);
+        stringColumns_.resize(stringVars_.size() * blockCapacity_);
+    }
 
-            for (const auto& [stepCount, times] : timeSamples_) {
-                if (precision_ > -1) {
-                    ss.precision(defaultPrecision);
-                    ss << times << "," << stepCount;
-                    ss.precision(precision_);
-                    ss << std::fixed;
-                } else {
-                    ss << times << "," << stepCount;
-                }
+    // Appends a row of values to the column buffers, and writes a block
+    // if they are full.
+    void append_binary_row(const log_sample& sample)
+    {
+        const auto row = blockRows_;
+        stepColumn_[row] = sample.step;
+        timeColumn_[row] = sample.time.time_since_epoch().count();
+        for (std::size_t i = 0; i < sample.reals.size(); ++i) {
+            realColumns_[i * blockCapacity_ + row] = sample.reals[i];
+        }
+        for (std::size_t i = 0; i < sample.integers.size(); ++i) {
+            intColumns_[i * blockCapacity_ + row] = sample.integers[i];
+        }
+        for (std::size_t i = 0; i < sample.booleans.size(); ++i) {
+            boolColumns_[i * blockCapacity_ + row] = sample.booleans[i];
+        }
+        for (std::size_t i = 0; i < sample.strings.size(); ++i) {
+            stringColumns_[i * blockCapacity_ + row] = sample.strings[i];
+        }
+        if (++blockRows_ == blockCapacity_) write_binary_block();
+    }
 
-                if (realSamples_.count(stepCount)) write<double>(realSamples_[stepCount], ss);
-                if (intSamples_.count(stepCount)) write<int>(intSamples_[stepCount], ss);
-                if (boolSamples_.count(stepCount)) write<bool>(boolSamples_[stepCount], ss);
-                if (stringSamples_.count(stepCount)) write<std::string_view>(stringSamples_[stepCount], ss);
+    // Writes the buffered rows as a block.
+    void write_binary_block()
+    {
+        if (blockRows_ == 0) return;
+        const auto rows = blockRows_;
+        std::uint64_t payloadSize = rows * (2 * sizeof(std::int64_t)
+                                               + realVars_.size() * sizeof(double)
+                                               + intVars_.size() * sizeof(std::int32_t)
+                                               + boolVars_.size() * sizeof(std::uint8_t)
+                                               + stringVars_.size() * sizeof(std::uint32_t));
+        for (std::size_t i = 0; i < stringVars_.size(); ++i) {
+            for (std::size_t r = 0; r < rows; ++r) {
+                payloadSize += stringColumns_[i * blockCapacity_ + r].size();
+            }
+        }
 
-                ss << std::endl;
+        auto& out = *binaryOutput_;
+        blockIndex_.push_back({out.position(), stepColumn_[0], static_cast<std::uint32_t>(rows)});
+        out.write_magic("BLCK");
+        out.write(static_cast<std::uint32_t>(rows));
+        out.write(payloadSize);
+        out.write_array(stepColumn_.data(), rows);
+        out.write_array(timeColumn_.data(), rows);
+        for (std::size_t i = 0; i < realVars_.size(); ++i) {
+            out.write_array(realColumns_.data() + i * blockCapacity_, rows);
+        }
+        for (std::size_t i = 0; i < intVars_.size(); ++i) {
+            out.write_array(intColumns_.data() + i * blockCapacity_, rows);
+        }
+        for (std::size_t i = 0; i < boolVars_.size(); ++i) {
+            out.write_array(boolColumns_.data() + i * blockCapacity_, rows);
+        }
+        for (std::size_t i = 0; i < stringVars_.size(); ++i) {
+            for (std::size_t r = 0; r < rows; ++r) {
+                out.write_string(stringColumns_[i * blockCapacity_ + r]);
             }
+        }
+        blockRows_ = 0;
+    }
 
-            fsw_ << ss.rdbuf();
+    // Writes any buffered rows, the block index and the trailer.
+    void finish_binary_segment()
+    {
+        write_binary_block();
+        auto& out = *binaryOutput_;
+        const auto indexOffset = out.position();
+        out.write(static_cast<std::uint64_t>(blockIndex_.size()));
+        for (const auto& entry : blockIndex_) {
+            out.write(entry.offset);
+            out.write(entry.firstStep);
+            out.write(entry.rowCount);
+        }
+        out.write(indexOffset);
+        out.write(out.position() + sizeof(std::uint64_t) + 8);
+        out.write_magic("COSIMIDX");
+        fsw_.flush();
+        binaryOutput_.reset();
+    }
+
+    void write_csv_row(const log_sample& sample)
+    {
+        std::stringstream ss;
+
+        ss << to_double_time_point(sample.time) << "," << sample.step;
+        if (precision_ > -1) {
+            ss.precision(precision_);
+            ss << std::fixed;
         }
 
-        realSamples_.clear();
-        intSamples_.clear();
-        boolSamples_.clear();
-        stringSamples_.clear();
-        timeSamples_.clear();
+        write(sample.reals, ss);
+        write(sample.integers, ss);
+        write(sample.booleans, ss);
+        write(sample.strings, ss);
+
+        ss << std::endl;
+
+        fsw_ << ss.rdbuf();
     }
 
-    std::map<step_number, std::vector<double>> realSamples_;
-    std::map<step_number, std::vector<int>> intSamples_;
-    std::map<step_number, std::vector<bool>> boolSamples_;
-    std::map<step_number, std::vector<std::string_view>> stringSamples_;
-    std::map<step_number, double> timeSamples_;
+    log_sample sample_;
     std::vector<variable_description> realVars_;
     std::vector<variable_description> intVars_;
     std::vector<variable_description> boolVars_;
     std::vector<variable_description> stringVars_;
+    std::vector<variable_slot> realSlots_;
+    std::vector<variable_slot> intSlots_;
+    std::vector<variable_slot> boolSlots_;
+    std::vector<variable_slot> stringSlots_;
     observable* observable_;
     cosim::filesystem::path logDir_;
     size_t decimationFactor_ = 1;
@@ -357,12 +655,158 @@ private:
     std::mutex mutex_;
     bool timeStampedFileNames_ = true;
     int precision_ = -1;
+    file_observer_format format_;
+
+    // Binary format state (see `file_observer_format::binary`)
+    struct block_index_entry
+    {
+        std::uint64_t offset;
+        std::int64_t firstStep;
+        std::uint32_t rowCount;
+    };
+    std::unique_ptr<utility::binary_output> binaryOutput_;
+    std::vector<block_index_entry> blockIndex_;
+    std::size_t blockCapacity_ = 0;
+    std::size_t blockRows_ = 0;
+    std::vector<std::int64_t> stepColumn_;
+    std::vector<std::int64_t> timeColumn_;
+    std::vector<double> realColumns_;
+    std::vector<std::int32_t> intColumns_;
+    std::vector<std::uint8_t> boolColumns_;
+    std::vector<std::string> stringColumns_;
+
+    // Asynchronous writing state.  `producerMutex_` serialises `observe()`
+    // with `stop_recording()`, so that no samples are queued after the
+    // latter has drained the buffer.
+    async_writer* asyncWriter_ = nullptr;
+    sample_ring ring_;
+    std::mutex producerMutex_;
 };
 
+
+file_observer::async_writer::async_writer(file_observer_overflow_policy policy)
+    : policy_(policy)
+{
+    thread_ = std::thread(&async_writer::run, this);
+}
+
+file_observer::async_writer::~async_writer() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    dataCv_.notify_one();
+    thread_.join();
+}
+
+void file_observer::async_writer::add(slave_value_writer* writer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    writers_.push_back(writer);
+}
+
+void file_observer::async_writer::remove(slave_value_writer* writer)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& ring = writer->ring();
+    spaceCv_.wait(lock, [&] { return ring.head == ring.tail; });
+    writers_.erase(std::find(writers_.begin(), writers_.end(), writer));
+}
+
+log_sample* file_observer::async_writer::begin_push(slave_value_writer& writer)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    auto& ring = writer.ring();
+    if (ring.tail - ring.head == ring.slots.size()) {
+        if (policy_ == file_observer_overflow_policy::drop) {
+            droppedCount_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        spaceCv_.wait(lock, [&] { return ring.tail - ring.head < ring.slots.size(); });
+    }
+    return &ring.slots[ring.tail % ring.slots.size()];
+}
+
+void file_observer::async_writer::end_push(slave_value_writer& writer)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++writer.ring().tail;
+    }
+    dataCv_.notify_one();
+}
+
+void file_observer::async_writer::drain(slave_value_writer& writer)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& ring = writer.ring();
+    spaceCv_.wait(lock, [&] { return ring.head == ring.tail; });
+}
+
+void file_observer::async_writer::rethrow_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+void file_observer::async_writer::run()
+{
+    struct pending_samples
+    {
+        slave_value_writer* writer;
+        std::size_t begin;
+        std::size_t end;
+    };
+    std::vector<pending_samples> batch;
+    std::exception_ptr error;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        batch.clear();
+        for (const auto writer : writers_) {
+            const auto& ring = writer->ring();
+            if (ring.head != ring.tail) batch.push_back({writer, ring.head, ring.tail});
+        }
+        if (batch.empty()) {
+            if (stop_) break;
+            dataCv_.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        for (const auto& pending : batch) {
+            const auto& slots = pending.writer->ring().slots;
+            try {
+                for (auto i = pending.begin; i != pending.end; ++i) {
+                    pending.writer->write_queued_sample(slots[i % slots.size()]);
+                }
+                pending.writer->flush();
+            } catch (...) {
+                // Keep only the first error; the samples are lost either way.
+                if (!error) error = std::current_exception();
+            }
+        }
+        lock.lock();
+
+        if (error && !error_) error_ = std::move(error);
+        error = nullptr;
+
+        for (const auto& pending : batch) {
+            pending.writer->ring().head = pending.end;
+        }
+        spaceCv_.notify_all();
+    }
+}
+
 file_observer::file_observer(const cosim::filesystem::path& logDir, std::optional<file_observer_config> config)
     : config_(std::move(config))
     , logDir_(cosim::filesystem::absolute(logDir))
 {
+    if (config_ && config_->asyncBufferSize_ > 0) {
+        asyncWriter_ = std::make_unique<async_writer>(config_->overflowPolicy_);
+    }
 }
 
 file_observer::file_observer(const filesystem::path& logDir, const filesystem::path& configPath)
@@ -405,7 +849,11 @@ void file_observer::simulator_added(
                 config.decimationFactor,
                 config.variables,
                 config.timeStampedFileNames,
-                config_->precision_);
+                config_->precision_,
+                config.format);
+            if (asyncWriter_) {
+                valueWriters_[index]->write_asynchronously(asyncWriter_.get(), config_->asyncBufferSize_);
+            }
         } else {
             return;
         }
@@ -416,7 +864,10 @@ void file_observer::simulator_added(
 
 void file_observer::simulator_removed(simulator_index index, time_point /*currentTime*/)
 {
-    valueWriters_.erase(index);
+    if (auto writer = valueWriters_.find(index); writer != valueWriters_.end()) {
+        if (asyncWriter_) asyncWriter_->remove(writer->second.get());
+        valueWriters_.erase(writer);
+    }
 }
 
 void file_observer::variables_connected(variable_id /*output*/, variable_id /*input*/, time_point /*currentTime*/)
@@ -461,6 +912,11 @@ cosim::filesystem::path file_observer::get_log_path()
     return logDir_;
 }
 
+std::uint64_t file_observer::get_dropped_sample_count() const
+{
+    return asyncWriter_ ? asyncWriter_->dropped_count() : 0;
+}
+
 bool file_observer::is_recording()
 {
     return recording_;
@@ -487,6 +943,7 @@ void file_observer::stop_recording()
             entry.second->stop_recording();
         }
         recording_ = false;
+        if (asyncWriter_) asyncWriter_->rethrow_error();
     }
 }
 
@@ -511,11 +968,13 @@ file_observer::simulator_logging_config file_observer::parse_config(const std::s
             simulator_logging_config config;
             config.timeStampedFileNames = timeStampedFileNames;
             config.decimationFactor = variables.first;
+            config.format = config_->format_;
 
             const auto& simulator = find_simulator(simulators_, modelName);
+            const auto md = simulator->model_description();
             if (variables.second.empty()) {
 
-                for (const auto& vd : simulator->model_description().variables) {
+                for (const auto& vd : md->variables) {
                     switch (vd.type) {
                         case variable_type::real:
                         case variable_type::integer:
@@ -528,13 +987,13 @@ file_observer::simulator_logging_config file_observer::parse_config(const std::s
                     }
                 }
             } else {
+                const auto lookup = variable_lookup(md);
                 for (const auto& name : variables.second) {
 
-                    const auto variableDescription =
-                        find_variable(simulator->model_description(), name);
+                    const auto variableDescription = lookup.find(name);
 
                     if (!variableDescription) {
-                        throw std::runtime_error("Can't find variable descriptor with name " + name + " for model with name " + simulator->model_description().name);
+                        throw std::runtime_error("Can't find variable descriptor with name " + name + " for model with name " + md->name);
                     }
 
                     switch (variableDescription->type) {
@@ -588,6 +1047,26 @@ file_observer_config file_observer_config::parse(const filesystem::path& configP
         if (const auto precision = get_optional_attribute<int>(*configuration, "floatingPointPrecision")) {
             config.fixed_precision(*precision);
         }
+        if (const auto format = get_optional_attribute<std::string>(*configuration, "outputFormat")) {
+            if (*format == "csv") {
+                config.set_output_format(file_observer_format::csv);
+            } else if (*format == "binary") {
+                config.set_output_format(file_observer_format::binary);
+            } else {
+                throw std::runtime_error("Invalid log output format: " + *format);
+            }
+        }
+        if (const auto bufferSize = get_optional_attribute<std::size_t>(*configuration, "asyncBufferSize")) {
+            auto policy = file_observer_overflow_policy::block;
+            if (const auto policyName = get_optional_attribute<std::string>(*configuration, "overflowPolicy")) {
+                if (*policyName == "drop") {
+                    policy = file_observer_overflow_policy::drop;
+                } else if (*policyName != "block") {
+                    throw std::runtime_error("Invalid log overflow policy: " + *policyName);
+                }
+            }
+            config.set_asynchronous_writing(*bufferSize, policy);
+        }
     }
 
     return config;
@@ -10,6 +10,8 @@
 
 #include <map>
 #include <mutex>
+#include <sstream>
+#include <stdexcept>
 
 
 namespace cosim
@@ -18,9 +20,13 @@ namespace cosim
 last_value_observer::last_value_observer()
 { }
 
+last_value_observer::last_value_observer(bool observeAllVariables)
+    : observeAllVariables_(observeAllVariables)
+{ }
+
 void last_value_observer::simulator_added(simulator_index index, observable* simulator, time_point /*currentTime*/)
 {
-    valueProviders_[index] = std::make_unique<slave_value_provider>(simulator);
+    valueProviders_[index] = std::make_unique<slave_value_provider>(simulator, observeAllVariables_);
 }
 
 void last_value_observer::simulator_removed(simulator_index index, time_point /*currentTime*/)
@@ -70,6 +76,37 @@ void last_value_observer::state_restored(
     }
 }
 
+namespace
+{
+void check_observable_type(variable_id id)
+{
+    switch (id.type) {
+        case variable_type::real:
+        case variable_type::integer:
+        case variable_type::boolean:
+        case variable_type::string:
+            return;
+        default:
+            std::ostringstream oss;
+            oss << "No support for observing variable with type " << id.type
+                << " and reference " << id.reference;
+            throw std::invalid_argument(oss.str());
+    }
+}
+} // namespace
+
+void last_value_observer::start_observing(variable_id id)
+{
+    check_observable_type(id);
+    valueProviders_.at(id.simulator)->start_observing(id.type, id.reference);
+}
+
+void last_value_observer::stop_observing(variable_id id)
+{
+    check_observable_type(id);
+    valueProviders_.at(id.simulator)->stop_observing(id.type, id.reference);
+}
+
 void last_value_observer::get_real(
     simulator_index sim,
     gsl::span<const value_reference> variables,
@@ -7,97 +7,208 @@
 
 #include "cosim/error.hpp"
 
-#include <mutex>
-
 namespace cosim
 {
 
 namespace
 {
 
-template<typename T>
+template<typename T, typename Values>
 void get(
     gsl::span<const value_reference> variables,
-    const std::unordered_map<value_reference, T>& samples,
+    const std::unordered_map<value_reference, std::size_t>& indices,
+    const Values& samples,
     gsl::span<T> values)
 {
     if (samples.empty()) {
         throw std::out_of_range("no samples available");
     }
     for (std::size_t i = 0; i < values.size(); i++) {
-        value_reference valueRef = variables[i];
-        values[i] = samples.at(valueRef);
+        values[i] = samples[indices.at(variables[i])];
     }
 }
 
 } // namespace
 
-slave_value_provider::slave_value_provider(observable* observable)
+
+class slave_value_provider::snapshot_reader
+{
+public:
+    explicit snapshot_reader(const std::atomic<snapshot*>& current)
+    {
+        // Register as a reader of the current snapshot, and check that it
+        // is still current afterwards.  Otherwise, `observe()` may have
+        // started overwriting it before our registration became visible.
+        snapshot_ = current.load();
+        while (true) {
+            snapshot_->readers.fetch_add(1);
+            auto latest = current.load();
+            if (latest == snapshot_) break;
+            snapshot_->readers.fetch_sub(1);
+            snapshot_ = latest;
+        }
+    }
+
+    ~snapshot_reader() noexcept
+    {
+        snapshot_->readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    snapshot_reader(const snapshot_reader&) = delete;
+    snapshot_reader& operator=(const snapshot_reader&) = delete;
+
+    const snapshot& operator*() const noexcept
+    {
+        return *snapshot_;
+    }
+
+private:
+    snapshot* snapshot_;
+};
+
+
+void slave_value_provider::variable_index::add(value_reference reference, variable_slot slot)
+{
+    if (indices.emplace(reference, references.size()).second) {
+        references.push_back(reference);
+        slots.push_back(slot);
+    }
+}
+
+void slave_value_provider::variable_index::remove(value_reference reference)
+{
+    const auto it = indices.find(reference);
+    if (it == indices.end()) return;
+    const auto index = it->second;
+    indices.erase(it);
+    if (index != references.size() - 1) {
+        references[index] = references.back();
+        slots[index] = slots.back();
+        indices[references[index]] = index;
+    }
+    references.pop_back();
+    slots.pop_back();
+}
+
+slave_value_provider::variable_index& slave_value_provider::variable_layout::of_type(variable_type type)
+{
+    switch (type) {
+        case cosim::variable_type::real:
+            return reals;
+        case cosim::variable_type::integer:
+            return integers;
+        case cosim::variable_type::boolean:
+            return booleans;
+        case cosim::variable_type::string:
+            return strings;
+        default:
+            COSIM_PANIC();
+    }
+}
+
+
+slave_value_provider::slave_value_provider(observable* observable, bool observeAllVariables)
     : observable_(observable)
 {
-    for (const auto& vd : observable->model_description().variables) {
-        observable->expose_for_getting(vd.type, vd.reference);
-        switch (vd.type) {
-            case cosim::variable_type::real:
-                realSamples_[vd.reference] = double();
-                break;
-            case cosim::variable_type::integer:
-                intSamples_[vd.reference] = int();
-                break;
-            case cosim::variable_type::boolean:
-                boolSamples_[vd.reference] = bool();
-                break;
-            case cosim::variable_type::string:
-                stringSamples_[vd.reference] = std::string();
-                break;
-            default:
-                COSIM_PANIC();
+    if (observeAllVariables) {
+        const auto md = observable->model_description();
+        for (const auto& vd : md->variables) {
+            const auto slot = observable->expose_for_getting(vd.type, vd.reference);
+            requestedLayout_.of_type(vd.type).add(vd.reference, slot);
         }
     }
+    layout_ = std::make_shared<const variable_layout>(requestedLayout_);
+
+    auto initial = std::make_unique<snapshot>();
+    initial->layout = layout_;
+    initial->reals.resize(layout_->reals.slots.size());
+    initial->integers.resize(layout_->integers.slots.size());
+    initial->booleans.resize(layout_->booleans.slots.size());
+    initial->strings.resize(layout_->strings.slots.size());
+    current_ = initial.get();
+    snapshots_.push_back(std::move(initial));
 }
 
 slave_value_provider::~slave_value_provider() noexcept = default;
 
+void slave_value_provider::start_observing(variable_type type, value_reference reference)
+{
+    auto& index = requestedLayout_.of_type(type);
+    if (index.indices.count(reference)) return;
+    index.add(reference, observable_->expose_for_getting(type, reference));
+    layoutChanged_ = true;
+}
+
+void slave_value_provider::stop_observing(variable_type type, value_reference reference)
+{
+    requestedLayout_.of_type(type).remove(reference);
+    layoutChanged_ = true;
+}
+
+slave_value_provider::snapshot* slave_value_provider::spare_snapshot()
+{
+    const auto current = current_.load(std::memory_order_relaxed);
+    for (const auto& s : snapshots_) {
+        if (s.get() != current && s->readers.load() == 0) return s.get();
+    }
+    snapshots_.push_back(std::make_unique<snapshot>());
+    return snapshots_.back().get();
+}
+
 void slave_value_provider::observe()
 {
-    std::lock_guard<std::mutex> lock(lock_);
+    if (layoutChanged_) {
+        layout_ = std::make_shared<const variable_layout>(requestedLayout_);
+        layoutChanged_ = false;
+    }
+
+    const auto s = spare_snapshot();
+    if (s->layout != layout_) {
+        s->layout = layout_;
+        s->reals.resize(layout_->reals.slots.size());
+        s->integers.resize(layout_->integers.slots.size());
+        s->booleans.resize(layout_->booleans.slots.size());
+        s->strings.resize(layout_->strings.slots.size());
+    }
 
-    for (auto& [idx, value] : realSamples_) {
-        value = observable_->get_real(idx);
+    const auto& layout = *layout_;
+    for (std::size_t i = 0; i < layout.reals.slots.size(); ++i) {
+        s->reals[i] = observable_->get_real(layout.reals.slots[i]);
     }
-    for (auto& [idx, value] : intSamples_) {
-        value = observable_->get_integer(idx);
+    for (std::size_t i = 0; i < layout.integers.slots.size(); ++i) {
+        s->integers[i] = observable_->get_integer(layout.integers.slots[i]);
     }
-    for (auto& [idx, value] : boolSamples_) {
-        value = observable_->get_boolean(idx);
+    for (std::size_t i = 0; i < layout.booleans.slots.size(); ++i) {
+        s->booleans[i] = observable_->get_boolean(layout.booleans.slots[i]);
     }
-    for (auto& [idx, value] : stringSamples_) {
-        value = observable_->get_string(idx);
+    for (std::size_t i = 0; i < layout.strings.slots.size(); ++i) {
+        s->strings[i] = observable_->get_string(layout.strings.slots[i]);
     }
+    current_.store(s);
 }
 
 void slave_value_provider::get_real(gsl::span<const value_reference> variables, gsl::span<double> values)
 {
-    std::lock_guard<std::mutex> lock(lock_);
-    get<double>(variables, realSamples_, values);
+    const auto reader = snapshot_reader(current_);
+    get(variables, (*reader).layout->reals.indices, (*reader).reals, values);
 }
 
 void slave_value_provider::get_int(gsl::span<const value_reference> variables, gsl::span<int> values)
 {
-    std::lock_guard<std::mutex> lock(lock_);
-    get<int>(variables, intSamples_, values);
+    const auto reader = snapshot_reader(current_);
+    get(variables, (*reader).layout->integers.indices, (*reader).integers, values);
 }
 
 void slave_value_provider::get_boolean(gsl::span<const value_reference> variables, gsl::span<bool> values)
 {
-    std::lock_guard<std::mutex> lock(lock_);
-    get<bool>(variables, boolSamples_, values);
+    const auto reader = snapshot_reader(current_);
+    get(variables, (*reader).layout->booleans.indices, (*reader).booleans, values);
 }
 
 void slave_value_provider::get_string(gsl::span<const value_reference> variables, gsl::span<std::string> values)
 {
-    std::lock_guard<std::mutex> lock(lock_);
-    get<std::string>(variables, stringSamples_, values);
+    const auto reader = snapshot_reader(current_);
+    get(variables, (*reader).layout->strings.indices, (*reader).strings, values);
 }
 
 } // namespace cosim
@@ -15,7 +15,9 @@
 
 #include <gsl/span>
 
-#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -23,12 +25,38 @@
 namespace cosim
 {
 
+/**
+ *  Stores the latest values of all variables of a simulator, and makes them
+ *  available to other threads.
+ *
+ *  The values are stored in *snapshots*, which contain dense arrays of
+ *  values for each variable type, and which are published atomically by
+ *  `observe()`.  A reader always reads from one snapshot, so the values it
+ *  gets are from the same step, and neither readers nor the observing
+ *  thread ever wait for a lock.  `observe()` writes to a snapshot which is
+ *  not in use by any reader, allocating a new one in the rare case that all
+ *  existing spare snapshots are still being read.
+ *
+ *  The set of observed variables may be changed with `start_observing()`
+ *  and `stop_observing()`.  Changes take effect in the next snapshot.
+ *
+ *  `observe()`, `start_observing()` and `stop_observing()` must only be
+ *  called from one thread at a time, and not while the simulator is
+ *  stepping, while the `get_xxx()` functions may be called concurrently
+ *  from any thread.
+ */
 class slave_value_provider
 {
 
 public:
-    slave_value_provider(observable* obs);
+    /**
+     *  Constructor.  If `observeAllVariables` is true, all variables are
+     *  observed from the start, otherwise none are.
+     */
+    slave_value_provider(observable* obs, bool observeAllVariables = true);
     ~slave_value_provider() noexcept;
+    void start_observing(variable_type type, value_reference reference);
+    void stop_observing(variable_type type, value_reference reference);
     void observe();
     void get_real(gsl::span<const value_reference> variables, gsl::span<double> values);
     void get_int(gsl::span<const value_reference> variables, gsl::span<int> values);
@@ -36,12 +64,58 @@ public:
     void get_string(gsl::span<const value_reference> variables, gsl::span<std::string> values);
 
 private:
-    std::unordered_map<value_reference, double> realSamples_;
-    std::unordered_map<value_reference, int> intSamples_;
-    std::unordered_map<value_reference, bool> boolSamples_;
-    std::unordered_map<value_reference, std::string> stringSamples_;
+    // The observed variables of one type.  `indices` maps value references
+    // to indices in the snapshot arrays, `references` and `slots`.
+    struct variable_index
+    {
+        std::unordered_map<value_reference, std::size_t> indices;
+        std::vector<value_reference> references;
+        std::vector<variable_slot> slots;
+
+        void add(value_reference reference, variable_slot slot);
+        void remove(value_reference reference);
+    };
+
+    struct variable_layout
+    {
+        variable_index reals;
+        variable_index integers;
+        variable_index booleans;
+        variable_index strings;
+
+        variable_index& of_type(variable_type type);
+    };
+
+    struct snapshot
+    {
+        std::shared_ptr<const variable_layout> layout;
+        std::vector<double> reals;
+        std::vector<int> integers;
+        std::vector<bool> booleans;
+        std::vector<std::string> strings;
+        std::atomic<int> readers = 0;
+    };
+
+    // Acquires the current snapshot for reading, and releases it when done.
+    class snapshot_reader;
+
+    snapshot* spare_snapshot();
+
     observable* observable_;
-    std::mutex lock_;
+
+    // The layout used for new snapshots, which is only accessed by the
+    // observing thread.
+    std::shared_ptr<const variable_layout> layout_;
+
+    // The requested layout, which is copied to `layout_` by `observe()`
+    // when `layoutChanged_` is set.
+    variable_layout requestedLayout_;
+    bool layoutChanged_ = false;
+
+    // All snapshots, owned by the observing thread, and the one that is
+    // currently published.
+    std::vector<std::unique_ptr<snapshot>> snapshots_;
+    std::atomic<snapshot*> current_;
 };
 
 } // namespace cosim
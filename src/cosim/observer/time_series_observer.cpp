@@ -7,9 +7,12 @@
 
 #include "cosim/error.hpp"
 
-#include <map>
+#include <algorithm>
+#include <functional>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 
 namespace cosim
@@ -17,61 +20,119 @@ namespace cosim
 
 namespace
 {
-template<typename T>
-size_t get_samples(
-    value_reference valueReference,
-    const std::map<value_reference, std::map<step_number, T>>& variables,
-    std::map<step_number, time_point> timeSamples,
-    step_number fromStep,
-    gsl::span<T> values,
-    gsl::span<step_number> steps,
-    gsl::span<time_point> times)
+
+// Returns the first index `i` in the range [begin, end) for which `pred(i)`
+// is false, assuming that `pred` is true for all indices before it and false
+// for all indices after it.  Returns `end` if there is no such index.
+template<typename Predicate>
+std::size_t partition_point(std::size_t begin, std::size_t end, Predicate pred)
 {
-    std::size_t samplesRead = 0;
-    const auto& samplesIt = variables.find(valueReference);
-    if (samplesIt != variables.end()) {
-        const auto& samples = samplesIt->second;
-        if (samples.empty()) {
-            throw std::out_of_range("No samples recorded yet!");
-        }
-        auto sampleIt = samples.begin();
-        if (fromStep >= sampleIt->first) {
-            sampleIt = samples.find(fromStep);
-            if (sampleIt == samples.end()) { // fromStep was not found, use next.
-                sampleIt = samples.upper_bound(fromStep);
-            }
-        }
-        for (samplesRead = 0; samplesRead < values.size(); samplesRead++) {
-            if ((sampleIt != samples.end()) && (sampleIt->first < fromStep + static_cast<step_number>(values.size()))) {
-                steps[samplesRead] = sampleIt->first;
-                values[samplesRead] = sampleIt->second;
-                times[samplesRead] = timeSamples[sampleIt->first];
-                sampleIt++;
-            } else {
-                break;
-            }
+    while (begin < end) {
+        const auto mid = begin + (end - begin) / 2;
+        if (pred(mid)) {
+            begin = mid + 1;
+        } else {
+            end = mid;
         }
     }
-    return samplesRead;
+    return begin;
 }
 
+// The samples of one variable, stored in a ring buffer parallel to the
+// observer's step and time ring buffers.  Only samples whose index is
+// greater than or equal to `firstIndex` are valid, as the ones before that
+// were recorded before the variable was observed.
 template<typename T>
-void adjustIfFull(std::map<step_number, T>& buffer, size_t maxSize)
+struct sample_column
+{
+    variable_slot slot;
+    std::size_t firstIndex = 0;
+    std::vector<T> values;
+};
+
+// A read-only view of the retained samples of a real variable, where sample
+// `i` (for `begin <= i < end`) is at position `i % capacity` of `steps` and
+// `values`.
+struct real_series_view
 {
-    if (buffer.size() > maxSize) {
-        buffer.erase(buffer.begin());
+    const step_number* steps = nullptr;
+    const double* values = nullptr;
+    std::size_t capacity = 1;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    step_number step_at(std::size_t index) const noexcept
+    {
+        return steps[index % capacity];
+    }
+
+    double value_at(std::size_t index) const noexcept
+    {
+        return values[index % capacity];
     }
+};
+
+// Reads two time-synchronized series, i.e., the values of the samples whose
+// step numbers are in both series and in the range
+// [fromStep, fromStep + values1.size()), by merging the two series.
+std::size_t merge_synchronized_series(
+    const real_series_view& series1,
+    const real_series_view& series2,
+    step_number fromStep,
+    gsl::span<double> values1,
+    gsl::span<double> values2)
+{
+    if (series1.begin == series1.end || series2.begin == series2.end) {
+        throw std::out_of_range("Samples for both variables not recorded yet!");
+    }
+    auto i = partition_point(series1.begin, series1.end, [&](std::size_t k) {
+        return series1.step_at(k) < fromStep;
+    });
+    auto j = partition_point(series2.begin, series2.end, [&](std::size_t k) {
+        return series2.step_at(k) < fromStep;
+    });
+    const auto endStep = fromStep + static_cast<step_number>(values1.size());
+
+    std::size_t samplesRead = 0;
+    while (i < series1.end && j < series2.end && samplesRead < values1.size()) {
+        const auto step1 = series1.step_at(i);
+        const auto step2 = series2.step_at(j);
+        if (step1 >= endStep || step2 >= endStep) {
+            break;
+        } else if (step1 < step2) {
+            ++i;
+        } else if (step2 < step1) {
+            ++j;
+        } else {
+            values1[samplesRead] = series1.value_at(i++);
+            values2[samplesRead] = series2.value_at(j++);
+            ++samplesRead;
+        }
+    }
+    return samplesRead;
 }
 
 } // namespace
 
+/*
+ *  The samples for one simulator are stored in fixed-capacity ring buffers:
+ *  one for step numbers, one for times, and one for each observed variable.
+ *
+ *  Samples are identified by their *index*, which is the number of samples
+ *  recorded before them (since the last reset), and sample `i` is stored at
+ *  position `i % capacity` in each ring.  Only the last `capacity` samples
+ *  are retained.  Since step numbers and times are strictly increasing,
+ *  lookups by either are done by binary search.
+ */
 class time_series_observer::single_slave_observer
 {
 
 public:
     single_slave_observer(observable* observable, time_point startTime, size_t bufSize)
         : observable_(observable)
-        , bufSize_(bufSize)
+        , capacity_(bufSize)
+        , steps_(bufSize)
+        , times_(bufSize)
     {
         observe(0, startTime);
     }
@@ -81,26 +142,37 @@ public:
     void observe(step_number timeStep, time_point currentTime)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        for (auto& [idx, samples] : realSamples_) {
-            samples[timeStep] = observable_->get_real(idx);
-            adjustIfFull(samples, bufSize_);
+
+        // A repeated observation of the same step replaces the previous one.
+        std::size_t index = count_;
+        if (count_ > 0 && steps_[(count_ - 1) % capacity_] == timeStep) {
+            index = count_ - 1;
+        } else {
+            ++count_;
+        }
+
+        const auto pos = index % capacity_;
+        steps_[pos] = timeStep;
+        times_[pos] = currentTime;
+        for (auto& [_, column] : realSamples_) {
+            column.values[pos] = observable_->get_real(column.slot);
+            column.firstIndex = std::min(column.firstIndex, index);
         }
-        for (auto& [idx, samples] : intSamples_) {
-            samples[timeStep] = observable_->get_integer(idx);
-            adjustIfFull(samples, bufSize_);
+        for (auto& [_, column] : intSamples_) {
+            column.values[pos] = observable_->get_integer(column.slot);
+            column.firstIndex = std::min(column.firstIndex, index);
         }
-        timeSamples_[timeStep] = currentTime;
-        adjustIfFull(timeSamples_, bufSize_);
     }
 
     void reset()
     {
-        timeSamples_.clear();
-        for (auto& [_, step_numbers] : realSamples_) {
-            step_numbers.clear();
+        std::lock_guard<std::mutex> lock(lock_);
+        count_ = 0;
+        for (auto& [_, column] : realSamples_) {
+            column.firstIndex = 0;
         }
-        for (auto& [_, step_numbers] : intSamples_) {
-            step_numbers.clear();
+        for (auto& [_, column] : intSamples_) {
+            column.firstIndex = 0;
         }
     }
 
@@ -109,12 +181,10 @@ public:
         std::lock_guard<std::mutex> lock(lock_);
         switch (type) {
             case variable_type::real:
-                realSamples_[reference] = std::map<step_number, double>();
-                observable_->expose_for_getting(type, reference);
+                realSamples_[reference] = new_column<double>(type, reference);
                 break;
             case variable_type::integer:
-                intSamples_[reference] = std::map<step_number, int>();
-                observable_->expose_for_getting(type, reference);
+                intSamples_[reference] = new_column<int>(type, reference);
                 break;
             default:
                 std::ostringstream oss;
@@ -145,72 +215,142 @@ public:
     size_t get_real_samples(value_reference valueReference, step_number fromStep, gsl::span<double> values, gsl::span<step_number> steps, gsl::span<time_point> times)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        return get_samples<double>(valueReference, realSamples_, timeSamples_, fromStep, values, steps, times);
+        return get_samples(realSamples_, valueReference, fromStep, values, steps, times);
     }
 
     size_t get_int_samples(value_reference valueReference, step_number fromStep, gsl::span<int> values, gsl::span<step_number> steps, gsl::span<time_point> times)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        return get_samples<int>(valueReference, intSamples_, timeSamples_, fromStep, values, steps, times);
+        return get_samples(intSamples_, valueReference, fromStep, values, steps, times);
     }
 
     void get_step_numbers(time_point tBegin, time_point tEnd, gsl::span<step_number> steps)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        step_number lastStep = timeSamples_.rbegin()->first;
-        auto lastEntry = std::find_if(
-            timeSamples_.begin(),
-            timeSamples_.end(),
-            [tEnd](const auto& entry) { return entry.second >= tEnd; });
-        if (lastEntry != timeSamples_.end()) {
-            lastStep = lastEntry->first;
-        }
-
-        step_number firstStep = timeSamples_.begin()->first;
-        auto firstEntry = std::find_if(
-            timeSamples_.rbegin(),
-            timeSamples_.rend(),
-            [tBegin](const auto& entry) { return entry.second <= tBegin; });
-        if (firstEntry != timeSamples_.rend()) {
-            firstStep = firstEntry->first;
-        }
-
-        steps[0] = firstStep;
-        steps[1] = lastStep;
+        const auto begin = first_index();
+
+        // The first sample at or after `tEnd`, or the last sample.
+        auto last = partition_point(begin, count_, [&](std::size_t i) {
+            return time_at(i) < tEnd;
+        });
+        if (last == count_) last = count_ - 1;
+
+        // The last sample at or before `tBegin`, or the first sample.
+        auto first = partition_point(begin, count_, [&](std::size_t i) {
+            return time_at(i) <= tBegin;
+        });
+        if (first > begin) --first;
+
+        steps[0] = step_at(first);
+        steps[1] = step_at(last);
     }
 
     void get_step_numbers(duration duration, gsl::span<step_number> steps)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        auto lastEntry = timeSamples_.rbegin();
-        step_number lastStep = lastEntry->first;
-
-        step_number firstStep = timeSamples_.begin()->first;
-        const time_point tBegin = lastEntry->second - duration;
-        auto firstIt = std::find_if(
-            timeSamples_.rbegin(),
-            timeSamples_.rend(),
-            [tBegin](const auto& entry) { return entry.second <= tBegin; });
-        if (firstIt != timeSamples_.rend()) {
-            firstStep = firstIt->first;
-        }
+        const auto begin = first_index();
+        const auto last = count_ - 1;
+
+        // The last sample at or before `duration` before the last one, or
+        // the first sample.
+        const time_point tBegin = time_at(last) - duration;
+        auto first = partition_point(begin, count_, [&](std::size_t i) {
+            return time_at(i) <= tBegin;
+        });
+        if (first > begin) --first;
+
+        steps[0] = step_at(first);
+        steps[1] = step_at(last);
+    }
 
-        steps[0] = firstStep;
-        steps[1] = lastStep;
+    /**
+     *  Returns a view of the retained samples of a real variable, which is
+     *  only valid while `mutex()` is locked.  Throws `std::out_of_range` if
+     *  the variable is not being observed.
+     */
+    real_series_view real_series(value_reference reference) const
+    {
+        const auto& column = realSamples_.at(reference);
+        real_series_view view;
+        view.steps = steps_.data();
+        view.values = column.values.data();
+        view.capacity = capacity_;
+        view.begin = std::max(first_index(), column.firstIndex);
+        view.end = std::max(view.begin, count_);
+        return view;
     }
 
-    std::map<step_number, double> get_real_samples_map(value_reference idx)
+    std::mutex& mutex() noexcept
     {
-        std::lock_guard<std::mutex> lock(lock_);
-        return realSamples_.at(idx);
+        return lock_;
     }
 
 private:
-    std::map<value_reference, std::map<step_number, double>> realSamples_;
-    std::map<value_reference, std::map<step_number, int>> intSamples_;
-    std::map<step_number, time_point> timeSamples_;
+    template<typename T>
+    sample_column<T> new_column(variable_type type, value_reference reference)
+    {
+        sample_column<T> column;
+        column.slot = observable_->expose_for_getting(type, reference);
+        column.firstIndex = count_;
+        column.values.resize(capacity_);
+        return column;
+    }
+
+    // The index of the oldest retained sample.
+    std::size_t first_index() const noexcept
+    {
+        return count_ > capacity_ ? count_ - capacity_ : 0;
+    }
+
+    step_number step_at(std::size_t index) const noexcept
+    {
+        return steps_[index % capacity_];
+    }
+
+    time_point time_at(std::size_t index) const noexcept
+    {
+        return times_[index % capacity_];
+    }
+
+    template<typename T>
+    std::size_t get_samples(
+        const std::unordered_map<value_reference, sample_column<T>>& columns,
+        value_reference valueReference,
+        step_number fromStep,
+        gsl::span<T> values,
+        gsl::span<step_number> steps,
+        gsl::span<time_point> times) const
+    {
+        const auto columnIt = columns.find(valueReference);
+        if (columnIt == columns.end()) return 0;
+        const auto& column = columnIt->second;
+
+        const auto begin = std::max(first_index(), column.firstIndex);
+        if (begin >= count_) {
+            throw std::out_of_range("No samples recorded yet!");
+        }
+        auto i = partition_point(begin, count_, [&](std::size_t j) {
+            return step_at(j) < fromStep;
+        });
+        const auto endStep = fromStep + static_cast<step_number>(values.size());
+
+        std::size_t samplesRead = 0;
+        for (; samplesRead < values.size() && i < count_ && step_at(i) < endStep; ++samplesRead, ++i) {
+            const auto pos = i % capacity_;
+            steps[samplesRead] = steps_[pos];
+            values[samplesRead] = column.values[pos];
+            times[samplesRead] = times_[pos];
+        }
+        return samplesRead;
+    }
+
+    std::unordered_map<value_reference, sample_column<double>> realSamples_;
+    std::unordered_map<value_reference, sample_column<int>> intSamples_;
     observable* observable_;
-    size_t bufSize_;
+    const std::size_t capacity_;
+    std::vector<step_number> steps_;
+    std::vector<time_point> times_;
+    std::size_t count_ = 0;
     std::mutex lock_;
 };
 
@@ -346,28 +486,55 @@ std::size_t time_series_observer::get_synchronized_real_series(
 {
     COSIM_INPUT_CHECK(values1.size() == values2.size());
 
-    const auto realSamples1 = slaveObservers_.at(sim1)->get_real_samples_map(valueReference1);
-    const auto realSamples2 = slaveObservers_.at(sim2)->get_real_samples_map(valueReference2);
+    const auto& observer1 = slaveObservers_.at(sim1);
+    const auto& observer2 = slaveObservers_.at(sim2);
+    std::unique_lock<std::mutex> lock1(observer1->mutex(), std::defer_lock);
+    std::unique_lock<std::mutex> lock2;
+    if (observer1 == observer2) {
+        lock1.lock();
+    } else {
+        lock2 = std::unique_lock<std::mutex>(observer2->mutex(), std::defer_lock);
+        std::lock(lock1, lock2);
+    }
+    return merge_synchronized_series(
+        observer1->real_series(valueReference1),
+        observer2->real_series(valueReference2),
+        fromStep,
+        values1,
+        values2);
+}
 
-    if (realSamples1.empty() || realSamples2.empty()) {
-        throw std::out_of_range("Samples for both variables not recorded yet!");
+void time_series_observer::get_synchronized_real_series(
+    gsl::span<const synchronized_real_series_query> queries,
+    gsl::span<std::size_t> samplesRead)
+{
+    COSIM_INPUT_CHECK(queries.size() == samplesRead.size());
+
+    // Lock all the involved simulators' observers, in a fixed order to
+    // avoid deadlocks.
+    std::vector<single_slave_observer*> observers;
+    for (const auto& query : queries) {
+        COSIM_INPUT_CHECK(query.values1.size() == query.values2.size());
+        observers.push_back(slaveObservers_.at(query.sim1).get());
+        observers.push_back(slaveObservers_.at(query.sim2).get());
     }
-    auto lastStep1 = realSamples1.rbegin()->first;
-    auto lastStep2 = realSamples2.rbegin()->first;
-
-    size_t samplesRead = 0;
-    for (auto step = fromStep; step < fromStep + static_cast<step_number>(values1.size()); step++) {
-        auto sample1 = realSamples1.find(step);
-        auto sample2 = realSamples2.find(step);
-        if (sample1 != realSamples1.end() && sample2 != realSamples2.end()) {
-            values1[samplesRead] = sample1->second;
-            values2[samplesRead] = sample2->second;
-            samplesRead++;
-        } else if (lastStep1 < step || lastStep2 < step) {
-            break;
-        }
+    std::sort(observers.begin(), observers.end(), std::less<>());
+    observers.erase(std::unique(observers.begin(), observers.end()), observers.end());
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(observers.size());
+    for (const auto observer : observers) {
+        locks.emplace_back(observer->mutex());
+    }
+
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        const auto& query = queries[i];
+        samplesRead[i] = merge_synchronized_series(
+            slaveObservers_.at(query.sim1)->real_series(query.valueReference1),
+            slaveObservers_.at(query.sim2)->real_series(query.valueReference2),
+            query.fromStep,
+            query.values1,
+            query.values2);
     }
-    return samplesRead;
 }
 
 time_series_observer::~time_series_observer() noexcept = default;
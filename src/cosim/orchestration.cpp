@@ -8,7 +8,13 @@
 #include "cosim/error.hpp"
 #include "cosim/fmi/fmu.hpp"
 #include "cosim/log/logger.hpp"
+#include "cosim/utility/thread_pool.hpp"
 
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #ifdef HAS_PROXYFMU
@@ -30,6 +36,15 @@ std::shared_ptr<model> model_uri_sub_resolver::lookup_model(
 }
 
 
+std::shared_ptr<model> model_uri_sub_resolver::lookup_model(
+    const uri& baseUri,
+    const uri& modelUriReference,
+    unsigned int /*maxThreads*/)
+{
+    return lookup_model(baseUri, modelUriReference);
+}
+
+
 // =============================================================================
 // class model_uri_resolver
 // =============================================================================
@@ -51,13 +66,7 @@ std::shared_ptr<model> model_uri_resolver::lookup_model(
     const uri& baseUri,
     const uri& modelUriReference)
 {
-    COSIM_INPUT_CHECK(baseUri.scheme().has_value() ||
-        modelUriReference.scheme().has_value());
-    for (auto sr : subResolvers_) {
-        if (auto r = sr->lookup_model(baseUri, modelUriReference)) return r;
-    }
-    throw std::runtime_error(
-        "No resolvers available to handle URI: " + std::string(modelUriReference.view()));
+    return lookup_model(baseUri, modelUriReference, std::thread::hardware_concurrency(), nullptr);
 }
 
 
@@ -72,6 +81,86 @@ std::shared_ptr<model> model_uri_resolver::lookup_model(const uri& modelUri)
 }
 
 
+std::shared_ptr<model> model_uri_resolver::lookup_model(
+    const uri& baseUri,
+    const uri& modelUriReference,
+    unsigned int maxThreads,
+    std::vector<std::mutex>* subResolverMutexes)
+{
+    COSIM_INPUT_CHECK(baseUri.scheme().has_value() ||
+        modelUriReference.scheme().has_value());
+    for (std::size_t i = 0; i < subResolvers_.size(); ++i) {
+        const auto& sr = subResolvers_[i];
+        auto lock = std::unique_lock<std::mutex>();
+        if (subResolverMutexes && !sr->supports_concurrent_lookups()) {
+            lock = std::unique_lock<std::mutex>((*subResolverMutexes)[i]);
+        }
+        if (auto r = sr->lookup_model(baseUri, modelUriReference, maxThreads)) return r;
+    }
+    throw std::runtime_error(
+        "No resolvers available to handle URI: " + std::string(modelUriReference.view()));
+}
+
+
+std::vector<std::shared_ptr<model>> model_uri_resolver::lookup_models(
+    const uri& baseUri,
+    const std::vector<uri>& modelUriReferences,
+    unsigned int maxThreads)
+{
+    // Map each reference to the first occurrence of the same reference.
+    std::vector<std::size_t> distinct;
+    std::vector<std::size_t> occurrence(modelUriReferences.size());
+    std::unordered_map<std::string_view, std::size_t> seen;
+    for (std::size_t i = 0; i < modelUriReferences.size(); ++i) {
+        const auto [it, inserted] = seen.try_emplace(modelUriReferences[i].view(), distinct.size());
+        if (inserted) distinct.push_back(i);
+        occurrence[i] = it->second;
+    }
+
+    std::vector<std::shared_ptr<model>> models(distinct.size());
+    std::vector<std::exception_ptr> errors(distinct.size());
+    maxThreads = std::max(maxThreads, 1u);
+    const auto threadCount = std::min<std::size_t>(maxThreads, distinct.size());
+
+    // Calls into sub-resolvers which don't support concurrent lookups are
+    // serialised, one mutex per sub-resolver, while other lookups proceed.
+    auto subResolverMutexes = std::vector<std::mutex>(subResolvers_.size());
+
+    // Share the remaining threads between the lookups, so that the total
+    // stays within `maxThreads`.
+    const auto threadsPerLookup =
+        std::max(maxThreads / static_cast<unsigned int>(threadCount), 1u);
+    const auto lookup = [&](std::size_t d) {
+        try {
+            models[d] = lookup_model(
+                baseUri,
+                modelUriReferences[distinct[d]],
+                threadsPerLookup,
+                &subResolverMutexes);
+        } catch (...) {
+            errors[d] = std::current_exception();
+        }
+    };
+    if (threadCount <= 1) {
+        for (std::size_t d = 0; d < distinct.size(); ++d) lookup(d);
+    } else {
+        auto pool = utility::thread_pool(static_cast<unsigned int>(threadCount));
+        for (std::size_t d = 0; d < distinct.size(); ++d) {
+            pool.submit([&lookup, d] { lookup(d); });
+        }
+        pool.wait_for_tasks_to_finish();
+    }
+
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    std::vector<std::shared_ptr<model>> result;
+    result.reserve(modelUriReferences.size());
+    for (const auto d : occurrence) result.push_back(models[d]);
+    return result;
+}
+
+
 // =============================================================================
 // class fmu_file_uri_sub_resolver
 // =============================================================================
@@ -115,6 +204,23 @@ fmu_file_uri_sub_resolver::fmu_file_uri_sub_resolver(
 
 
 std::shared_ptr<model> fmu_file_uri_sub_resolver::lookup_model(const uri& modelUri)
+{
+    return import_fmu(modelUri, std::thread::hardware_concurrency());
+}
+
+
+std::shared_ptr<model> fmu_file_uri_sub_resolver::lookup_model(
+    const uri& baseUri,
+    const uri& modelUriReference,
+    unsigned int maxThreads)
+{
+    return import_fmu(resolve_reference(baseUri, modelUriReference), maxThreads);
+}
+
+
+std::shared_ptr<model> fmu_file_uri_sub_resolver::import_fmu(
+    const uri& modelUri,
+    unsigned int maxThreads)
 {
     assert(modelUri.scheme().has_value());
     if (*modelUri.scheme() != "file") return nullptr;
@@ -131,7 +237,7 @@ std::shared_ptr<model> fmu_file_uri_sub_resolver::lookup_model(const uri& modelU
     }
     const auto path = file_uri_to_path(modelUri);
     if (path.extension() != ".fmu") return nullptr;
-    auto fmu = importer_->import(path);
+    auto fmu = importer_->import(path, maxThreads);
     return std::make_shared<fmu_model>(fmu);
 }
 
@@ -1199,9 +1199,15 @@ osp_config load_osp_config(
 
     auto simulators = parser.get_elements();
 
+    // Resolve (and unpack) all the models up front, in parallel.
+    std::vector<uri> modelUris;
+    for (const auto& simulator : simulators) modelUris.emplace_back(simulator.source);
+    const auto models = resolver.lookup_models(baseURI, modelUris);
+
     std::unordered_map<std::string, extended_model_description> emds;
-    for (const auto& simulator : simulators) {
-        auto model = resolver.lookup_model(baseURI, simulator.source);
+    for (std::size_t simulatorIndex = 0; simulatorIndex < simulators.size(); ++simulatorIndex) {
+        const auto& simulator = simulators[simulatorIndex];
+        const auto& model = models[simulatorIndex];
         config.system_structure.add_entity(
             simulator.name,
             model,
@@ -26,6 +26,8 @@ class proxy_uri_sub_resolver : public model_uri_sub_resolver
 {
 
 public:
+    using model_uri_sub_resolver::lookup_model;
+
     std::shared_ptr<model> lookup_model(const uri& baseUri, const uri& modelUriReference) override;
     std::shared_ptr<model> lookup_model(const cosim::uri& uri) override;
 };
@@ -1,5 +1,6 @@
 #include <cosim/log/logger.hpp>
 #include <cosim/serialization.hpp>
+#include <cosim/utility/binary_stream.hpp>
 
 #include <cbor.h>
 
@@ -7,6 +8,7 @@
 #include <iostream>
 #include <iterator>
 #include <optional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 
@@ -575,6 +577,92 @@ namespace
 
         return in;
     }
+
+    // Visitor class which writes the value contained in a node to a binary
+    // output stream.
+    struct binary_data_writer
+    {
+        cosim::utility::binary_output& out;
+
+        template<typename T>
+        void operator()(const T& value) { out.write(value); }
+
+        void operator()(std::nullptr_t) { }
+
+        void operator()(bool value) { out.write(static_cast<std::uint8_t>(value)); }
+
+        void operator()(const std::string& str) { out.write_string(str); }
+
+        void operator()(const std::vector<std::byte>& blob)
+        {
+            out.write(static_cast<std::uint64_t>(blob.size()));
+            out.write_array(blob.data(), blob.size());
+        }
+    };
+
+    void serialize_binary(cosim::utility::binary_output& out, const cosim::serialization::node& data)
+    {
+        out.write(static_cast<std::uint8_t>(data.data().index()));
+        std::visit(binary_data_writer{out}, data.data());
+        out.write(static_cast<std::uint64_t>(data.size()));
+        for (const auto& [key, child] : data) {
+            out.write_string(key);
+            serialize_binary(out, child);
+        }
+    }
+
+    // Reads a value of the `node_data` alternative with index `typeIndex`.
+    template<std::size_t I = 0>
+    cosim::serialization::node_data deserialize_binary_data(
+        cosim::utility::binary_input& in,
+        std::size_t typeIndex)
+    {
+        using cosim::serialization::node_data;
+        if constexpr (I == std::variant_size_v<node_data>) {
+            throw cosim::error(
+                make_error_code(cosim::errc::bad_file),
+                "Unknown data type in binary serialized data");
+        } else {
+            if (typeIndex != I) return deserialize_binary_data<I + 1>(in, typeIndex);
+
+            using T = std::variant_alternative_t<I, node_data>;
+            if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                return nullptr;
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return in.read<std::uint8_t>() != 0;
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return in.read_string();
+            } else if constexpr (std::is_same_v<T, std::vector<std::byte>>) {
+                return in.read_vector<std::byte>(in.read<std::uint64_t>());
+            } else {
+                return in.read<T>();
+            }
+        }
+    }
+
+    // The maximum nesting depth of binary serialized data, which protects
+    // against stack overflow on corrupt input.
+    constexpr int max_binary_depth = 256;
+
+    // Children are read straight into the tree, to avoid copying subtrees.
+    void deserialize_binary(
+        cosim::utility::binary_input& in,
+        cosim::serialization::node& data,
+        int depth = 0)
+    {
+        if (depth > max_binary_depth) {
+            throw cosim::error(
+                make_error_code(cosim::errc::bad_file),
+                "Binary serialized data are nested too deeply");
+        }
+        data.data() = deserialize_binary_data(in, in.read<std::uint8_t>());
+        const auto childCount = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < childCount; ++i) {
+            auto key = in.read_string();
+            auto child = data.push_back({std::move(key), cosim::serialization::node()});
+            deserialize_binary(in, child->second, depth + 1);
+        }
+    }
 }
 
 namespace cosim
@@ -596,7 +684,30 @@ std::ios_base& pretty_print(std::ios_base& os)
     return os;
 }
 
+std::ios_base& binary(std::ios_base& os)
+{
+    os.iword(format_xalloc) = FORMAT_BINARY;
+    return os;
+}
+
 } // namespace format
+
+
+void write_binary(std::ostream& out, const node& data)
+{
+    auto binaryOut = utility::binary_output(out);
+    serialize_binary(binaryOut, data);
+}
+
+
+node read_binary(std::istream& in)
+{
+    auto binaryIn = utility::binary_input(in);
+    node data;
+    deserialize_binary(binaryIn, data);
+    return data;
+}
+
 } // namespace serialization
 } // namespace cosim
 
@@ -611,6 +722,9 @@ std::ostream& operator<<(std::ostream& out, const cosim::serialization::node& da
         constexpr int indentStep = 2;
         print_ptree(out, data, 0, indentStep);
         return out;
+    } else if (format == cosim::serialization::format::FORMAT_BINARY) {
+        cosim::serialization::write_binary(out, data);
+        return out;
     }
 
     // Default fallback
@@ -625,6 +739,9 @@ std::istream& operator>>(std::istream& in, cosim::serialization::node& root)
 
     if (format == cosim::serialization::format::FORMAT_CBOR) {
         return deserialize_cbor(in, root);
+    } else if (format == cosim::serialization::format::FORMAT_BINARY) {
+        root = cosim::serialization::read_binary(in);
+        return in;
     }
 
     // Default fallback
@@ -8,12 +8,20 @@
 #include "cosim/error.hpp"
 #include "cosim/exception.hpp"
 
+#include "cosim/utility/binary_stream.hpp"
+
 #include <cosim/utility/utility.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 
 
 namespace cosim
@@ -33,6 +41,57 @@ struct var_view_type<std::string>
     using type = std::string_view;
 };
 
+template<typename Src, typename Tgt>
+void copy_contents(Src&& src, Tgt&& tgt)
+{
+    assert(static_cast<std::size_t>(src.size()) <= static_cast<std::size_t>(tgt.size()));
+    std::copy(src.data(), src.data() + src.size(), tgt.data());
+}
+
+// Writes an array of variable values to a binary stream.  Numbers are
+// written as a block, booleans as one byte each and strings with their
+// lengths.
+template<typename T>
+void write_values(utility::binary_output& out, const T* values, std::size_t count)
+{
+    if constexpr (std::is_same_v<T, std::string>) {
+        for (std::size_t i = 0; i < count; ++i) out.write_string(values[i]);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        for (std::size_t i = 0; i < count; ++i) out.write(static_cast<std::uint8_t>(values[i]));
+    } else {
+        out.write_array(values, count);
+    }
+}
+
+// Reads an array of variable values written with `write_values()`.
+template<typename T>
+void read_values(utility::binary_input& in, T* values, std::size_t count)
+{
+    if constexpr (std::is_same_v<T, std::string>) {
+        for (std::size_t i = 0; i < count; ++i) values[i] = in.read_string();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        for (std::size_t i = 0; i < count; ++i) values[i] = in.read<std::uint8_t>() != 0;
+    } else {
+        in.read_array(values, count);
+    }
+}
+
+// Reads the value references and values of a variable cache from a binary
+// stream and passes them to `store(reference, value)`.
+template<typename T, typename Store>
+void read_cache_contents(utility::binary_input& in, Store&& store)
+{
+    // The references are read first, so that the values are only
+    // allocated once we know that the count is not corrupt.
+    const auto references = in.read_vector<value_reference>(in.read<std::uint64_t>());
+    const auto count = references.size();
+    auto values = boost::container::vector<T>(count);
+    read_values(in, values.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        store(references[i], std::move(values[i]));
+    }
+}
+
 template<typename T>
 struct get_variable_cache
 {
@@ -42,14 +101,78 @@ struct get_variable_cache
     std::vector<std::function<T(T, duration)>> modifiers;
     std::unordered_map<value_reference, std::size_t> indexMapping;
 
-    void expose(value_reference r)
+    // The number of steps between each time a variable must be retrieved,
+    // and whether any of them is greater than 1.
+    std::vector<step_number> periods;
+    bool periodic = false;
+
+    // The variables which are due for retrieval after the current step,
+    // when only a subset of them is.
+    std::vector<value_reference> dueReferences;
+    std::vector<std::size_t> dueIndices;
+    bool subsetDue = false;
+
+    // Returns the variable's index in the cache arrays, which is used as
+    // its `variable_slot`.  If the variable is already exposed, its period
+    // becomes the greatest common divisor of the old and new periods, which
+    // divides every step number at which either of them is due.
+    std::size_t expose(value_reference r, step_number period = 1)
     {
-        if (indexMapping.count(r)) return;
+        assert(period > 0);
+        if (period > 1) periodic = true;
+        const auto it = indexMapping.find(r);
+        if (it != indexMapping.end()) {
+            periods[it->second] = std::gcd(periods[it->second], period);
+            return it->second;
+        }
         references.push_back(r);
         originalValues.push_back(T()); // TODO: Use start value from model description
         modifiedValues.push_back(T());
         modifiers.emplace_back();
+        periods.push_back(period);
         indexMapping[r] = references.size() - 1;
+        return references.size() - 1;
+    }
+
+    // Returns the slot of a variable whose value is being imported.  Unlike
+    // `expose()`, this leaves the period of an already exposed variable as
+    // it is.
+    std::size_t import_slot(value_reference r)
+    {
+        const auto it = indexMapping.find(r);
+        return it != indexMapping.end() ? it->second : expose(r);
+    }
+
+    // Returns the references of the variables which must be retrieved after
+    // step number `n`, or all of them if `n` is unknown.
+    gsl::span<const value_reference> due_references(std::optional<step_number> n)
+    {
+        subsetDue = periodic && n;
+        if (!subsetDue) return references;
+        dueReferences.clear();
+        dueIndices.clear();
+        for (std::size_t i = 0; i < references.size(); ++i) {
+            if (*n % periods[i] == 0) {
+                dueReferences.push_back(references[i]);
+                dueIndices.push_back(i);
+            }
+        }
+        return dueReferences;
+    }
+
+    // Stores the values retrieved for the references returned by the last
+    // `due_references()` call.
+    template<typename Values>
+    void store(const Values& values)
+    {
+        if (!subsetDue) {
+            copy_contents(values, originalValues);
+            return;
+        }
+        assert(static_cast<std::size_t>(values.size()) == dueIndices.size());
+        for (std::size_t i = 0; i < dueIndices.size(); ++i) {
+            originalValues[dueIndices[i]] = values[i];
+        }
     }
 
     typename var_view_type<T>::type get(value_reference r) const
@@ -65,6 +188,14 @@ struct get_variable_cache
         }
     }
 
+    typename var_view_type<T>::type get(variable_slot slot) const
+    {
+        if (slot.index >= modifiedValues.size()) {
+            throw std::out_of_range("Invalid variable slot");
+        }
+        return modifiedValues[slot.index];
+    }
+
     void set_modifier(value_reference r, std::function<T(T, duration)> m)
     {
         modifiers[indexMapping[r]] = m;
@@ -94,23 +225,35 @@ struct get_variable_cache
         return exportedState;
     }
 
+    // Variables which are already exposed keep their indexes, so that
+    // previously returned slots remain valid, and their retrieval periods.
     void import_state(const serialization::node& exportedState)
     {
-        std::vector<value_reference> importedReferences;
-        boost::container::vector<T> importedValues;
-        std::unordered_map<value_reference, std::size_t> newMapping;
         for (const auto& [key, child] : exportedState) {
             const value_reference ref = std::stoul(key);
-            const auto val = child.template get_value<T>();
-            importedReferences.push_back(ref);
-            importedValues.push_back(val);
-            newMapping[ref] = importedReferences.size() - 1;
+            originalValues[import_slot(ref)] = child.template get_value<T>();
         }
-        references.swap(importedReferences);
-        originalValues.swap(importedValues);
         modifiedValues = originalValues; // copy
         modifiers.assign(modifiedValues.size(), nullptr);
-        indexMapping.swap(newMapping);
+    }
+
+    // Writes the references followed by the values, as typed arrays.
+    void export_state(utility::binary_output& out) const
+    {
+        assert(references.size() == originalValues.size());
+        assert(std::all_of(modifiers.begin(), modifiers.end(), [](auto m) { return !m; }));
+        out.write(static_cast<std::uint64_t>(references.size()));
+        out.write_array(references.data(), references.size());
+        write_values(out, originalValues.data(), originalValues.size());
+    }
+
+    void import_state(utility::binary_input& in)
+    {
+        read_cache_contents<T>(in, [this](value_reference ref, T&& value) {
+            originalValues[import_slot(ref)] = std::move(value);
+        });
+        modifiedValues = originalValues; // copy
+        modifiers.assign(modifiedValues.size(), nullptr);
     }
 };
 
@@ -119,39 +262,38 @@ template<typename T>
 class set_variable_cache
 {
 public:
-    void expose(value_reference r, T startValue)
+    // Returns the variable's index in `exposedVariables_`, which is used as
+    // its `variable_slot`.
+    std::size_t expose(value_reference r, T startValue)
     {
-        exposedVariables_.emplace(r, exposed_variable{startValue, -1});
+        const auto [it, inserted] = slotIndexes_.try_emplace(r, exposedVariables_.size());
+        if (inserted) exposedVariables_.push_back(exposed_variable{r, startValue, -1});
+        return it->second;
     }
 
     void set_value(value_reference r, typename var_view_type<T>::type v)
+    {
+        set_value(variable_slot{slot_index(r, "set_value"), r}, v);
+    }
+
+    void set_value(variable_slot slot, typename var_view_type<T>::type v)
     {
         assert(!hasRunModifiers_);
-        const auto it = exposedVariables_.find(r);
-        if (it == exposedVariables_.end()) {
-            std::ostringstream oss;
-            oss << "Variable with value reference " << r
-                << " not found in exposed variables. Variables must be exposed before calling set_value()";
-            throw std::out_of_range(oss.str());
+        if (slot.index >= exposedVariables_.size()) {
+            throw std::out_of_range("Invalid variable slot");
         }
-        it->second.lastValue = v;
-        if (!make_cache_slot(r, it->second)) {
-            assert(references_[it->second.arrayIndex] == r);
-            values_[it->second.arrayIndex] = v;
+        auto& var = exposedVariables_[slot.index];
+        var.lastValue = v;
+        if (!make_cache_slot(var)) {
+            assert(references_[var.arrayIndex] == var.reference);
+            values_[var.arrayIndex] = v;
         }
     }
 
     void set_modifier(value_reference r, std::function<T(T, duration)> m)
     {
         assert(!hasRunModifiers_);
-        const auto it = exposedVariables_.find(r);
-        if (it == exposedVariables_.end()) {
-            std::ostringstream oss;
-            oss << "Variable with value reference " << r
-                << " not found in exposed variables. Variables must be exposed before calling set_modifier()";
-            throw std::out_of_range(oss.str());
-        }
-        make_cache_slot(r, it->second);
+        make_cache_slot(exposedVariables_[slot_index(r, "set_modifier")]);
         if (m) {
             modifiers_[r] = m;
         } else {
@@ -165,9 +307,8 @@ public:
     {
         if (!hasRunModifiers_) {
             for (const auto& entry : modifiers_) {
-                const auto ref = entry.first;
-                auto& exposedVariable = exposedVariables_.at(ref);
-                make_cache_slot(ref, exposedVariable);
+                auto& exposedVariable = exposedVariables_[slotIndexes_.at(entry.first)];
+                make_cache_slot(exposedVariable);
                 values_[exposedVariable.arrayIndex] =
                     entry.second(values_[exposedVariable.arrayIndex], deltaT);
             }
@@ -197,9 +338,10 @@ public:
 
     void reset()
     {
-        for (auto ref : references_) {
-            exposedVariables_.at(ref).arrayIndex = -1;
+        for (const auto index : cachedSlots_) {
+            exposedVariables_[index].arrayIndex = -1;
         }
+        cachedSlots_.clear();
         references_.clear();
         values_.clear();
         references_filtered_.clear();
@@ -211,30 +353,54 @@ public:
     {
         assert(modifiers_.empty());
         serialization::node exportedState;
-        for (const auto& [ref, var] : exposedVariables_) {
-            exportedState.put(std::to_string(ref), var.lastValue);
+        for (const auto& var : exposedVariables_) {
+            exportedState.put(std::to_string(var.reference), var.lastValue);
         }
         return exportedState;
     }
 
+    // Variables which are already exposed keep their indexes, so that
+    // previously returned slots remain valid.
     void import_state(const serialization::node& exportedState)
     {
-        assert(modifiers_.empty());
-        std::unordered_map<value_reference, exposed_variable> variables;
+        modifiers_.clear();
         for (const auto& [key, child] : exportedState) {
-            variables.emplace(
-                std::stoul(key),
-                exposed_variable{child.template get_value<T>()});
+            import_value(std::stoul(key), child.template get_value<T>());
         }
-        exposedVariables_.swap(variables);
-        hasRunModifiers_ = false;
-        references_.clear();
-        values_.clear();
+        reset();
+    }
+
+    // Writes the references followed by the values, as typed arrays.
+    void export_state(utility::binary_output& out) const
+    {
+        assert(modifiers_.empty());
+        const auto count = exposedVariables_.size();
+        auto references = std::vector<value_reference>(count);
+        auto values = boost::container::vector<T>(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            references[i] = exposedVariables_[i].reference;
+            values[i] = exposedVariables_[i].lastValue;
+        }
+        out.write(static_cast<std::uint64_t>(count));
+        out.write_array(references.data(), count);
+        write_values(out, values.data(), count);
+    }
+
+    void import_state(utility::binary_input& in)
+    {
+        modifiers_.clear();
+        read_cache_contents<T>(in, [this](value_reference ref, T&& value) {
+            import_value(ref, std::move(value));
+        });
+        reset();
     }
 
 private:
     struct exposed_variable
     {
+        // The variable's value reference.
+        value_reference reference = 0;
+
         // The last set value of the variable.
         T lastValue = T();
 
@@ -247,20 +413,50 @@ private:
     // `references_` and `values_` arrays, this function creates them and
     // returns `true`.  Otherwise, it returns `false` to signify that no new
     // slot needed to be created.
-    bool make_cache_slot(value_reference ref, exposed_variable& var)
+    bool make_cache_slot(exposed_variable& var)
     {
         if (var.arrayIndex < 0) {
             var.arrayIndex = references_.size();
             assert(references_.size() == values_.size());
-            references_.emplace_back(ref);
+            references_.emplace_back(var.reference);
             values_.emplace_back(var.lastValue);
+            cachedSlots_.push_back(&var - exposedVariables_.data());
             return true;
         } else {
             return false;
         }
     }
 
-    std::unordered_map<value_reference, exposed_variable> exposedVariables_;
+    // Sets the last value of a variable, exposing it if necessary.
+    void import_value(value_reference ref, T value)
+    {
+        const auto [it, inserted] = slotIndexes_.try_emplace(ref, exposedVariables_.size());
+        if (inserted) {
+            exposedVariables_.push_back(exposed_variable{ref, std::move(value), -1});
+        } else {
+            exposedVariables_[it->second].lastValue = std::move(value);
+        }
+    }
+
+    // Looks up the index of an exposed variable in `exposedVariables_`, or
+    // throws `std::out_of_range` if it hasn't been exposed.
+    std::size_t slot_index(value_reference r, const char* caller) const
+    {
+        const auto it = slotIndexes_.find(r);
+        if (it == slotIndexes_.end()) {
+            std::ostringstream oss;
+            oss << "Variable with value reference " << r
+                << " not found in exposed variables. Variables must be exposed before calling "
+                << caller << "()";
+            throw std::out_of_range(oss.str());
+        }
+        return it->second;
+    }
+
+    // The exposed variables, in the order they were exposed, and a mapping
+    // from value reference to position in this list.
+    std::vector<exposed_variable> exposedVariables_;
+    std::unordered_map<value_reference, std::size_t> slotIndexes_;
 
     // The modifiers associated with certain variables, and a flag that
     // specifies whether they have been run on the values currently in
@@ -272,6 +468,10 @@ private:
     std::vector<value_reference> references_;
     boost::container::vector<T> values_;
 
+    // The indexes in `exposedVariables_` of the variables in `references_`,
+    // so that `reset()` only needs to visit those.
+    std::vector<std::size_t> cachedSlots_;
+
     // Filtered references and values of the values to be set next (if a filter is applied).
     std::vector<value_reference> references_filtered_;
     boost::container::vector<T> values_filtered_;
@@ -279,13 +479,6 @@ private:
 
 
 // Copies the contents of a contiguous-storage container or span into another.
-template<typename Src, typename Tgt>
-void copy_contents(Src&& src, Tgt&& tgt)
-{
-    assert(static_cast<std::size_t>(src.size()) <= static_cast<std::size_t>(tgt.size()));
-    std::copy(src.data(), src.data() + src.size(), tgt.data());
-}
-
 template<typename T>
 T get_start_value(variable_description vd)
 {
@@ -301,7 +494,8 @@ public:
     impl(std::shared_ptr<slave> slave, std::string_view name)
         : slave_(std::move(slave))
         , name_(name)
-        , modelDescription_(slave_->model_description())
+        , modelDescription_(std::make_shared<const cosim::model_description>(slave_->model_description()))
+        , variableLookup_(modelDescription_)
     {
         assert(slave_);
         assert(!name_.empty());
@@ -322,27 +516,25 @@ public:
         return name_;
     }
 
-    cosim::model_description model_description() const
+    std::shared_ptr<const cosim::model_description> model_description() const
     {
         return modelDescription_;
     }
 
-    void expose_for_getting(variable_type type, value_reference ref)
+    variable_slot expose_for_getting(variable_type type, value_reference ref, step_number period)
     {
+        COSIM_INPUT_CHECK(period > 0);
         switch (type) {
             case variable_type::real:
-                state_.realGetCache.expose(ref);
-                break;
+                return {state_.realGetCache.expose(ref, period), ref};
             case variable_type::integer:
-                state_.integerGetCache.expose(ref);
-                break;
+                return {state_.integerGetCache.expose(ref, period), ref};
             case variable_type::boolean:
-                state_.booleanGetCache.expose(ref);
-                break;
+                return {state_.booleanGetCache.expose(ref, period), ref};
             case variable_type::string:
-                state_.stringGetCache.expose(ref);
-                break;
+                return {state_.stringGetCache.expose(ref, period), ref};
             case variable_type::enumeration:
+            default:
                 COSIM_PANIC();
         }
     }
@@ -367,23 +559,40 @@ public:
         return state_.stringGetCache.get(ref);
     }
 
-    void expose_for_setting(variable_type type, value_reference ref)
+    double get_real(variable_slot slot) const
+    {
+        return state_.realGetCache.get(slot);
+    }
+
+    int get_integer(variable_slot slot) const
     {
-        const auto vd = find_variable_description(ref, type);
+        return state_.integerGetCache.get(slot);
+    }
+
+    bool get_boolean(variable_slot slot) const
+    {
+        return state_.booleanGetCache.get(slot);
+    }
+
+    std::string_view get_string(variable_slot slot) const
+    {
+        return state_.stringGetCache.get(slot);
+    }
+
+    variable_slot expose_for_setting(variable_type type, value_reference ref)
+    {
+        const auto& vd = find_variable_description(ref, type);
         switch (type) {
             case variable_type::real:
-                state_.realSetCache.expose(ref, get_start_value<double>(vd));
-                break;
+                return {state_.realSetCache.expose(ref, get_start_value<double>(vd)), ref};
             case variable_type::integer:
-                state_.integerSetCache.expose(ref, get_start_value<int>(vd));
-                break;
+                return {state_.integerSetCache.expose(ref, get_start_value<int>(vd)), ref};
             case variable_type::boolean:
-                state_.booleanSetCache.expose(ref, get_start_value<bool>(vd));
-                break;
+                return {state_.booleanSetCache.expose(ref, get_start_value<bool>(vd)), ref};
             case variable_type::string:
-                state_.stringSetCache.expose(ref, get_start_value<std::string>(vd));
-                break;
+                return {state_.stringSetCache.expose(ref, get_start_value<std::string>(vd)), ref};
             case variable_type::enumeration:
+            default:
                 COSIM_PANIC();
         }
     }
@@ -408,6 +617,26 @@ public:
         state_.stringSetCache.set_value(ref, value);
     }
 
+    void set_real(variable_slot slot, double value)
+    {
+        state_.realSetCache.set_value(slot, value);
+    }
+
+    void set_integer(variable_slot slot, int value)
+    {
+        state_.integerSetCache.set_value(slot, value);
+    }
+
+    void set_boolean(variable_slot slot, bool value)
+    {
+        state_.booleanSetCache.set_value(slot, value);
+    }
+
+    void set_string(variable_slot slot, std::string_view value)
+    {
+        state_.stringSetCache.set_value(slot, value);
+    }
+
     void set_real_input_modifier(
         value_reference ref,
         std::function<double(double, duration)> modifier)
@@ -538,16 +767,35 @@ public:
         get_variables(duration::zero());
     }
 
+    void set_next_step_number(step_number n)
+    {
+        nextStepNumber_ = n;
+    }
+
     step_result do_step(
         time_point currentT,
         duration deltaT)
     {
+        // The step number only applies to a single step.
+        const auto stepNumber = std::exchange(nextStepNumber_, std::nullopt);
+        if (stepMetrics_ && stepMetrics_->enabled()) {
+            return timed_do_step(currentT, deltaT, stepNumber);
+        }
         set_variables(deltaT);
         const auto result = slave_->do_step(currentT, deltaT);
-        get_variables(deltaT);
+        get_variables(deltaT, stepNumber);
         return result;
     }
 
+    void set_step_metrics(
+        std::shared_ptr<const step_metrics> metrics,
+        simulator_step_metrics* simulatorMetrics)
+    {
+        COSIM_INPUT_CHECK(!metrics || simulatorMetrics);
+        stepMetrics_ = std::move(metrics);
+        simulatorMetrics_ = simulatorMetrics;
+    }
+
     simulator::state_index save_state()
     {
         check_state_saving_allowed();
@@ -568,6 +816,9 @@ public:
         check_state_saving_allowed();
         slave_->restore_state(stateIndex);
         state_ = savedStates_.at(stateIndex);
+        // Values of periodically retrieved variables may have been out of
+        // date when the state was saved.
+        if (periodic_retrieval()) get_variables(duration::zero());
     }
 
     void release_state(simulator::state_index stateIndex)
@@ -613,7 +864,9 @@ public:
             const auto stateIndex =
                 slave_->import_state(exportedState.get_child("state"));
             assert(savedStates_.count(stateIndex) == 0);
-            auto& savedState = savedStates_.try_emplace(stateIndex).first->second;
+            // The imported state is merged into a copy of the current one,
+            // so that the variables' slots are preserved.
+            auto& savedState = savedStates_.try_emplace(stateIndex, state_).first->second;
             savedState.realGetCache.import_state(exportedState.get_child("real_get_cache"));
             savedState.integerGetCache.import_state(exportedState.get_child("integer_get_cache"));
             savedState.booleanGetCache.import_state(exportedState.get_child("boolean_get_cache"));
@@ -636,7 +889,76 @@ public:
         }
     }
 
+    // The binary format consists of the scheme version, the slave's state
+    // and the contents of the variable caches, without any intermediate
+    // `serialization::node` for the caches.
+    void export_state_binary(state_index stateIndex, std::ostream& out) const
+    {
+        auto binaryOut = utility::binary_output(out);
+        binaryOut.write(export_scheme_version);
+        serialization::write_binary(out, slave_->export_state(stateIndex));
+        const auto& savedState = savedStates_.at(stateIndex);
+        savedState.realGetCache.export_state(binaryOut);
+        savedState.integerGetCache.export_state(binaryOut);
+        savedState.booleanGetCache.export_state(binaryOut);
+        savedState.stringGetCache.export_state(binaryOut);
+        savedState.realSetCache.export_state(binaryOut);
+        savedState.integerSetCache.export_state(binaryOut);
+        savedState.booleanSetCache.export_state(binaryOut);
+        savedState.stringSetCache.export_state(binaryOut);
+    }
+
+    state_index import_state_binary(std::istream& in)
+    {
+        auto binaryIn = utility::binary_input(in);
+        if (binaryIn.read<std::int32_t>() != export_scheme_version) {
+            throw error(
+                make_error_code(errc::bad_file),
+                "The serialized state of subsimulator '" + name_
+                    + "' uses an incompatible scheme");
+        }
+        const auto stateIndex = slave_->import_state(serialization::read_binary(in));
+        assert(savedStates_.count(stateIndex) == 0);
+        try {
+            // The imported state is merged into a copy of the current one,
+            // so that the variables' slots are preserved.
+            auto& savedState = savedStates_.try_emplace(stateIndex, state_).first->second;
+            savedState.realGetCache.import_state(binaryIn);
+            savedState.integerGetCache.import_state(binaryIn);
+            savedState.booleanGetCache.import_state(binaryIn);
+            savedState.stringGetCache.import_state(binaryIn);
+            savedState.realSetCache.import_state(binaryIn);
+            savedState.integerSetCache.import_state(binaryIn);
+            savedState.booleanSetCache.import_state(binaryIn);
+            savedState.stringSetCache.import_state(binaryIn);
+        } catch (...) {
+            release_state(stateIndex);
+            throw;
+        }
+        return stateIndex;
+    }
+
 private:
+    // Same as `do_step()`, but records step timing metrics.
+    step_result timed_do_step(
+        time_point currentT,
+        duration deltaT,
+        std::optional<step_number> stepNumber)
+    {
+        using wall_clock = std::chrono::steady_clock;
+        const auto t0 = wall_clock::now();
+        set_variables(deltaT);
+        const auto t1 = wall_clock::now();
+        const auto result = slave_->do_step(currentT, deltaT);
+        const auto t2 = wall_clock::now();
+        get_variables(deltaT, stepNumber);
+        const auto t3 = wall_clock::now();
+        simulatorMetrics_->set_variables.record(std::chrono::duration_cast<duration>(t1 - t0));
+        simulatorMetrics_->do_step.record(std::chrono::duration_cast<duration>(t2 - t1));
+        simulatorMetrics_->get_variables.record(std::chrono::duration_cast<duration>(t3 - t2));
+        return result;
+    }
+
     void set_variables(duration deltaT)
     {
         const auto [realRefs, realValues] = state_.realSetCache.modify_and_get(deltaT);
@@ -658,38 +980,43 @@ private:
         state_.stringSetCache.reset();
     }
 
-    void get_variables(duration deltaT)
+    // Retrieves the variables which are due after step number `stepNumber`,
+    // or all exposed variables if it is unknown.
+    void get_variables(duration deltaT, std::optional<step_number> stepNumber = std::nullopt)
     {
         slave_->get_variables(
             &variableValues_,
-            gsl::make_span(state_.realGetCache.references),
-            gsl::make_span(state_.integerGetCache.references),
-            gsl::make_span(state_.booleanGetCache.references),
-            gsl::make_span(state_.stringGetCache.references));
-        copy_contents(variableValues_.real, state_.realGetCache.originalValues);
-        copy_contents(variableValues_.integer, state_.integerGetCache.originalValues);
-        copy_contents(variableValues_.boolean, state_.booleanGetCache.originalValues);
-        copy_contents(variableValues_.string, state_.stringGetCache.originalValues);
+            state_.realGetCache.due_references(stepNumber),
+            state_.integerGetCache.due_references(stepNumber),
+            state_.booleanGetCache.due_references(stepNumber),
+            state_.stringGetCache.due_references(stepNumber));
+        state_.realGetCache.store(variableValues_.real);
+        state_.integerGetCache.store(variableValues_.integer);
+        state_.booleanGetCache.store(variableValues_.boolean);
+        state_.stringGetCache.store(variableValues_.string);
         state_.realGetCache.run_modifiers(deltaT);
         state_.integerGetCache.run_modifiers(deltaT);
         state_.booleanGetCache.run_modifiers(deltaT);
         state_.stringGetCache.run_modifiers(deltaT);
     }
 
-    variable_description find_variable_description(value_reference ref, variable_type type)
+    const variable_description& find_variable_description(value_reference ref, variable_type type) const
     {
-        auto it = std::find_if(
-            modelDescription_.variables.begin(),
-            modelDescription_.variables.end(),
-            [type, ref](const auto& vd) { return vd.type == type && vd.reference == ref; });
-        if (it == modelDescription_.variables.end()) {
+        const auto vd = variableLookup_.find(type, ref);
+        if (!vd) {
             std::ostringstream oss;
             oss << "Variable with value reference " << ref
                 << " and type " << type
                 << " not found in model description for " << name_;
             throw std::out_of_range(oss.str());
         }
-        return *it;
+        return *vd;
+    }
+
+    bool periodic_retrieval() const
+    {
+        return state_.realGetCache.periodic || state_.integerGetCache.periodic ||
+            state_.booleanGetCache.periodic || state_.stringGetCache.periodic;
     }
 
     void set_modified_reference(std::unordered_set<value_reference>& modifiedRefs, value_reference& ref, bool modifier)
@@ -715,7 +1042,8 @@ private:
 private:
     std::shared_ptr<slave> slave_;
     std::string name_;
-    cosim::model_description modelDescription_;
+    std::shared_ptr<const cosim::model_description> modelDescription_;
+    variable_lookup variableLookup_;
 
     struct state
     {
@@ -740,6 +1068,13 @@ private:
     // This is a temporary storage which gets reused within certain functions
     // to avoid frequent reallocations.
     cosim::slave::variable_values variableValues_;
+
+    // The step number passed to `set_next_step_number()`, if any, which
+    // applies to the next `do_step()` call.
+    std::optional<step_number> nextStepNumber_;
+
+    std::shared_ptr<const step_metrics> stepMetrics_;
+    simulator_step_metrics* simulatorMetrics_ = nullptr;
 };
 
 
@@ -764,15 +1099,24 @@ std::string slave_simulator::name() const
 }
 
 
-cosim::model_description slave_simulator::model_description() const
+std::shared_ptr<const cosim::model_description> slave_simulator::model_description() const
 {
     return pimpl_->model_description();
 }
 
 
-void slave_simulator::expose_for_getting(variable_type type, value_reference ref)
+variable_slot slave_simulator::expose_for_getting(variable_type type, value_reference ref)
+{
+    return pimpl_->expose_for_getting(type, ref, 1);
+}
+
+
+variable_slot slave_simulator::expose_for_periodic_getting(
+    variable_type type,
+    value_reference ref,
+    step_number period)
 {
-    pimpl_->expose_for_getting(type, ref);
+    return pimpl_->expose_for_getting(type, ref, period);
 }
 
 
@@ -800,9 +1144,33 @@ std::string_view slave_simulator::get_string(value_reference ref) const
 }
 
 
-void slave_simulator::expose_for_setting(variable_type type, value_reference ref)
+double slave_simulator::get_real(variable_slot slot) const
+{
+    return pimpl_->get_real(slot);
+}
+
+
+int slave_simulator::get_integer(variable_slot slot) const
+{
+    return pimpl_->get_integer(slot);
+}
+
+
+bool slave_simulator::get_boolean(variable_slot slot) const
 {
-    pimpl_->expose_for_setting(type, ref);
+    return pimpl_->get_boolean(slot);
+}
+
+
+std::string_view slave_simulator::get_string(variable_slot slot) const
+{
+    return pimpl_->get_string(slot);
+}
+
+
+variable_slot slave_simulator::expose_for_setting(variable_type type, value_reference ref)
+{
+    return pimpl_->expose_for_setting(type, ref);
 }
 
 
@@ -829,6 +1197,30 @@ void slave_simulator::set_string(value_reference ref, std::string_view value)
     pimpl_->set_string(ref, value);
 }
 
+
+void slave_simulator::set_real(variable_slot slot, double value)
+{
+    pimpl_->set_real(slot, value);
+}
+
+
+void slave_simulator::set_integer(variable_slot slot, int value)
+{
+    pimpl_->set_integer(slot, value);
+}
+
+
+void slave_simulator::set_boolean(variable_slot slot, bool value)
+{
+    pimpl_->set_boolean(slot, value);
+}
+
+
+void slave_simulator::set_string(variable_slot slot, std::string_view value)
+{
+    pimpl_->set_string(slot, value);
+}
+
 void slave_simulator::set_real_input_modifier(
     value_reference ref,
     std::function<double(double, duration)> modifier)
@@ -923,6 +1315,11 @@ void slave_simulator::start_simulation()
     return pimpl_->start_simulation();
 }
 
+void slave_simulator::set_next_step_number(step_number n)
+{
+    pimpl_->set_next_step_number(n);
+}
+
 step_result slave_simulator::do_step(
     time_point currentT,
     duration deltaT)
@@ -930,6 +1327,13 @@ step_result slave_simulator::do_step(
     return pimpl_->do_step(currentT, deltaT);
 }
 
+void slave_simulator::set_step_metrics(
+    std::shared_ptr<const step_metrics> metrics,
+    simulator_step_metrics* simulatorMetrics)
+{
+    pimpl_->set_step_metrics(std::move(metrics), simulatorMetrics);
+}
+
 simulator::state_index slave_simulator::save_state()
 {
     return pimpl_->save_state();
@@ -961,5 +1365,15 @@ simulator::state_index slave_simulator::import_state(
     return pimpl_->import_state(exportedState);
 }
 
+void slave_simulator::export_state_binary(state_index stateIndex, std::ostream& out) const
+{
+    pimpl_->export_state_binary(stateIndex, out);
+}
+
+simulator::state_index slave_simulator::import_state_binary(std::istream& in)
+{
+    return pimpl_->import_state_binary(in);
+}
+
 
 } // namespace cosim
@@ -12,6 +12,7 @@
 
 #include <cosim/algorithm.hpp>
 #include <cosim/slave.hpp>
+#include <cosim/step_metrics.hpp>
 
 #include <memory>
 #include <string_view>
@@ -35,20 +36,32 @@ public:
 
     // `observable` methods
     std::string name() const override;
-    cosim::model_description model_description() const override;
+    std::shared_ptr<const cosim::model_description> model_description() const override;
 
-    void expose_for_getting(variable_type type, value_reference ref) override;
+    variable_slot expose_for_getting(variable_type type, value_reference ref) override;
+    variable_slot expose_for_periodic_getting(
+        variable_type type,
+        value_reference ref,
+        step_number period) override;
     double get_real(value_reference reference) const override;
     int get_integer(value_reference reference) const override;
     bool get_boolean(value_reference reference) const override;
     std::string_view get_string(value_reference reference) const override;
+    double get_real(variable_slot slot) const override;
+    int get_integer(variable_slot slot) const override;
+    bool get_boolean(variable_slot slot) const override;
+    std::string_view get_string(variable_slot slot) const override;
 
     // `simulator` methods
-    void expose_for_setting(variable_type type, value_reference ref) override;
+    variable_slot expose_for_setting(variable_type type, value_reference ref) override;
     void set_real(value_reference reference, double value) override;
     void set_integer(value_reference reference, int value) override;
     void set_boolean(value_reference reference, bool value) override;
     void set_string(value_reference reference, std::string_view value) override;
+    void set_real(variable_slot slot, double value) override;
+    void set_integer(variable_slot slot, int value) override;
+    void set_boolean(variable_slot slot, bool value) override;
+    void set_string(variable_slot slot, std::string_view value) override;
 
     void set_real_input_modifier(
         value_reference reference,
@@ -89,6 +102,8 @@ public:
 
     void start_simulation() override;
 
+    void set_next_step_number(step_number n) override;
+
     step_result do_step(
         time_point currentT,
         duration deltaT) override;
@@ -99,6 +114,16 @@ public:
     void release_state(state_index stateIndex) override;
     serialization::node export_state(state_index stateIndex) const override;
     state_index import_state(const serialization::node& exportedState) override;
+    void export_state_binary(state_index stateIndex, std::ostream& out) const override;
+    state_index import_state_binary(std::istream& in) override;
+
+    /**
+     *  Sets the objects in which step timing metrics for this simulator
+     *  are recorded while `metrics->enabled()` is true.
+     */
+    void set_step_metrics(
+        std::shared_ptr<const step_metrics> metrics,
+        simulator_step_metrics* simulatorMetrics);
 
 private:
     class impl;
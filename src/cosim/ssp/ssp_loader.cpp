@@ -12,6 +12,7 @@
 #include "cosim/utility/zip.hpp"
 
 #include <random>
+#include <vector>
 
 
 namespace cosim
@@ -93,10 +94,17 @@ ssp_configuration ssp_loader::load(const cosim::filesystem::path& configPath)
     configuration.parameter_sets[""]; // Ensure that the default set exists.
 
     auto elements = parser.get_elements();
+
+    // Resolve (and unpack) all the models up front, in parallel.
+    std::vector<uri> modelUris;
+    for (const auto& entry : elements) modelUris.emplace_back(entry.second.source);
+    const auto models = modelResolver_->lookup_models(baseURI, modelUris);
+
+    std::size_t elementIndex = 0;
     for (const auto& [componentName, component] : elements) {
         configuration.system_structure.add_entity(
             componentName,
-            modelResolver_->lookup_model(baseURI, component.source),
+            models[elementIndex++],
             cosim::to_duration(component.stepSizeHint.value_or(0)));
 
         for (const auto& paramSet : component.parameterSets) {
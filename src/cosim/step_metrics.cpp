@@ -0,0 +1,142 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "cosim/step_metrics.hpp"
+
+#include "cosim/error.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace cosim
+{
+
+namespace
+{
+
+std::size_t bucket_index(duration d) noexcept
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    std::size_t i = 0;
+    while (micros > 0 && i < duration_histogram::bucket_count - 1) {
+        micros >>= 1;
+        ++i;
+    }
+    return i;
+}
+
+} // namespace
+
+
+duration duration_histogram::snapshot::mean() const noexcept
+{
+    if (count == 0) return duration::zero();
+    return total / static_cast<duration::rep>(count);
+}
+
+
+duration duration_histogram::snapshot::percentile(double p) const noexcept
+{
+    const auto threshold = static_cast<std::uint64_t>(
+        std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(count)));
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        cumulative += counts[i];
+        if (cumulative > 0 && cumulative >= threshold) return bucket_upper_bound(i);
+    }
+    return duration::zero();
+}
+
+
+duration_histogram::duration_histogram(std::size_t windowSize)
+    : generationSize_(std::max<std::uint64_t>(windowSize / 2, 1))
+    , current_(0)
+    , totalCount_(0)
+    , totalDuration_(0)
+    , last_(0)
+{
+    for (auto& gen : generations_) {
+        for (auto& c : gen.counts) c.store(0, std::memory_order_relaxed);
+        gen.count.store(0, std::memory_order_relaxed);
+        gen.total.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void duration_histogram::record(duration d) noexcept
+{
+    const auto current = current_.load(std::memory_order_relaxed);
+    auto& gen = generations_[current];
+    gen.counts[bucket_index(d)].fetch_add(1, std::memory_order_relaxed);
+    gen.total.fetch_add(d.count(), std::memory_order_relaxed);
+    if (gen.count.fetch_add(1, std::memory_order_relaxed) + 1 >= generationSize_) {
+        const auto next = 1 - current;
+        auto& nextGen = generations_[next];
+        for (auto& c : nextGen.counts) c.store(0, std::memory_order_relaxed);
+        nextGen.count.store(0, std::memory_order_relaxed);
+        nextGen.total.store(0, std::memory_order_relaxed);
+        current_.store(next, std::memory_order_release);
+    }
+    totalCount_.fetch_add(1, std::memory_order_relaxed);
+    totalDuration_.fetch_add(d.count(), std::memory_order_relaxed);
+    last_.store(d.count(), std::memory_order_relaxed);
+}
+
+
+duration_histogram::snapshot duration_histogram::read() const noexcept
+{
+    snapshot s;
+    for (const auto& gen : generations_) {
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            s.counts[i] += gen.counts[i].load(std::memory_order_relaxed);
+        }
+        s.total += duration(gen.total.load(std::memory_order_relaxed));
+    }
+    for (const auto c : s.counts) s.count += c;
+    return s;
+}
+
+
+std::uint64_t duration_histogram::total_count() const noexcept
+{
+    return totalCount_.load(std::memory_order_relaxed);
+}
+
+
+duration duration_histogram::total_duration() const noexcept
+{
+    return duration(totalDuration_.load(std::memory_order_relaxed));
+}
+
+
+duration duration_histogram::last() const noexcept
+{
+    return duration(last_.load(std::memory_order_relaxed));
+}
+
+
+duration duration_histogram::bucket_upper_bound(std::size_t i) noexcept
+{
+    if (i >= bucket_count - 1) return duration::max();
+    return std::chrono::microseconds(std::int64_t(1) << i);
+}
+
+
+const simulator_step_metrics& step_metrics::simulator(std::size_t index) const
+{
+    COSIM_INPUT_CHECK(index < simulators_.size());
+    return *simulators_[index];
+}
+
+
+simulator_step_metrics& step_metrics::add_simulator()
+{
+    return *simulators_.emplace_back(std::make_unique<simulator_step_metrics>());
+}
+
+
+} // namespace cosim
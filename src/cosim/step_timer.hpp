@@ -0,0 +1,59 @@
+/**
+ *  \file
+ *  Scoped timing of operations for `cosim::step_metrics`.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_STEP_TIMER_HPP
+#define COSIM_STEP_TIMER_HPP
+
+#include <cosim/step_metrics.hpp>
+
+#include <chrono>
+
+
+namespace cosim
+{
+namespace detail
+{
+
+/**
+ *  Records the wall-clock time between its construction and destruction
+ *  in one of the histograms in `metrics`, if metrics collection is enabled.
+ *
+ *  If metrics collection is disabled (or `metrics` is null), this doesn't
+ *  even read the clock.
+ */
+class step_timer
+{
+public:
+    step_timer(step_metrics* metrics, duration_histogram step_metrics::*histogram) noexcept
+        : histogram_(metrics && metrics->enabled() ? &(metrics->*histogram) : nullptr)
+    {
+        if (histogram_) start_ = std::chrono::steady_clock::now();
+    }
+
+    step_timer(const step_timer&) = delete;
+    step_timer& operator=(const step_timer&) = delete;
+    step_timer(step_timer&&) = delete;
+    step_timer& operator=(step_timer&&) = delete;
+
+    ~step_timer() noexcept
+    {
+        if (histogram_) {
+            histogram_->record(std::chrono::duration_cast<duration>(
+                std::chrono::steady_clock::now() - start_));
+        }
+    }
+
+private:
+    duration_histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace detail
+} // namespace cosim
+#endif // COSIM_STEP_TIMER_HPP
@@ -0,0 +1,178 @@
+/**
+ *  \file
+ *  Simple binary I/O on standard streams.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_UTILITY_BINARY_STREAM_HPP
+#define COSIM_UTILITY_BINARY_STREAM_HPP
+
+#include <cosim/exception.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+
+namespace cosim
+{
+namespace utility
+{
+
+
+/**
+ *  A binary output stream which keeps track of the number of bytes written.
+ *
+ *  Values are written in the native byte order and representation.
+ *  Strings are written as a 32-bit length followed by the characters.
+ */
+class binary_output
+{
+public:
+    explicit binary_output(std::ostream& stream)
+        : stream_(stream)
+    { }
+
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void write_array(const T* values, std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(values, count * sizeof(T));
+    }
+
+    void write_string(std::string_view value)
+    {
+        write(static_cast<std::uint32_t>(value.size()));
+        write_bytes(value.data(), value.size());
+    }
+
+    void write_magic(const char* magic)
+    {
+        write_bytes(magic, std::strlen(magic));
+    }
+
+    std::uint64_t position() const noexcept
+    {
+        return position_;
+    }
+
+private:
+    void write_bytes(const void* data, std::size_t size)
+    {
+        stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position_ += size;
+    }
+
+    std::ostream& stream_;
+    std::uint64_t position_ = 0;
+};
+
+
+/**
+ *  A binary input stream which reads data written with `binary_output`.
+ *
+ *  All functions throw `cosim::error` with code `errc::bad_file` if the
+ *  stream ends prematurely.  Strings and vectors whose lengths are read
+ *  from the stream are read in bounded chunks, so that a corrupt length
+ *  causes such an error rather than a huge allocation.
+ */
+class binary_input
+{
+public:
+    explicit binary_input(std::istream& stream)
+        : stream_(stream)
+    { }
+
+    template<typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        read_bytes(&value, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void read_array(T* values, std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        read_bytes(values, count * sizeof(T));
+    }
+
+    /// Reads `count` values, which were not preceded by their count.
+    template<typename T>
+    std::vector<T> read_vector(std::uint64_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::vector<T> values;
+        read_chunked(values, count);
+        return values;
+    }
+
+    std::string read_string()
+    {
+        std::string value;
+        read_chunked(value, read<std::uint32_t>());
+        return value;
+    }
+
+    /// Reads `std::strlen(magic)` bytes and returns whether they equal `magic`.
+    bool read_magic(const char* magic)
+    {
+        auto value = std::string(std::strlen(magic), '\0');
+        read_bytes(value.data(), value.size());
+        return value == magic;
+    }
+
+private:
+    // The maximum number of bytes allocated ahead of the data that are
+    // actually read.
+    static constexpr std::size_t max_chunk_size = 1 << 20;
+
+    // Resizes `container` to `count` elements while reading them, one
+    // chunk at a time.
+    template<typename Container>
+    void read_chunked(Container& container, std::uint64_t count)
+    {
+        using T = typename Container::value_type;
+        constexpr auto chunkCount = std::max<std::size_t>(max_chunk_size / sizeof(T), 1);
+        while (container.size() < count) {
+            const auto offset = container.size();
+            const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(count - offset, chunkCount));
+            container.resize(offset + n);
+            read_bytes(container.data() + offset, n * sizeof(T));
+        }
+    }
+
+    void read_bytes(void* data, std::size_t size)
+    {
+        stream_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (static_cast<std::size_t>(stream_.gcount()) != size) {
+            throw error(make_error_code(errc::bad_file), "Unexpected end of binary data");
+        }
+    }
+
+    std::istream& stream_;
+};
+
+
+} // namespace utility
+} // namespace cosim
+#endif // COSIM_UTILITY_BINARY_STREAM_HPP
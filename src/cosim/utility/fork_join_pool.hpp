@@ -0,0 +1,254 @@
+/**
+ *  \file
+ *  A fork/join worker pool for barrier-synchronised workloads.
+ *
+ *  \copyright
+ *      This Source Code Form is subject to the terms of the Mozilla Public
+ *      License, v. 2.0. If a copy of the MPL was not distributed with this
+ *      file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#ifndef COSIM_UTILITY_FORK_JOIN_POOL_HPP
+#define COSIM_UTILITY_FORK_JOIN_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#endif
+
+
+namespace cosim
+{
+namespace utility
+{
+
+/// Hints to the processor that the calling thread is in a spin-wait loop.
+inline void cpu_relax() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+
+/**
+ *  A fork/join pool with persistent worker threads.
+ *
+ *  This is an alternative to `thread_pool` which is tailored to the
+ *  barrier-per-step pattern of the co-simulation algorithms, where the same
+ *  fixed set of tasks (e.g. one per simulator) is run over and over again,
+ *  and the caller must wait for all of them to finish before proceeding.
+ *
+ *  `run()` publishes a job by bumping an atomic epoch counter.  The job is
+ *  identified by a task count and a callable, and task `i` is always executed
+ *  by participant `i % (thread_count() + 1)`, where participant 0 is the
+ *  calling thread.  Thus, as long as the task indices are stable, each task
+ *  (simulator) stays pinned to the same thread from step to step.
+ *
+ *  Idle workers, as well as the caller while it waits for the workers to
+ *  finish, spin for a bounded number of iterations before parking on a
+ *  condition variable.  No heap allocation is performed per job or per task.
+ *
+ *  `run()` may only be called from one thread at a time.
+ */
+class fork_join_pool
+{
+public:
+    /// The default number of spin iterations before a waiting thread parks.
+    static constexpr unsigned int default_spin_count = 4096;
+
+    /**
+     *  Constructor.
+     *
+     *  \param threadCount
+     *      The number of worker threads to spawn.  If zero, all tasks are
+     *      run on the calling thread.
+     *  \param spinCount
+     *      The number of times a waiting thread polls for new work (or for
+     *      job completion) before it parks.
+     */
+    explicit fork_join_pool(unsigned int threadCount, unsigned int spinCount = default_spin_count)
+        : spinCount_(spinCount)
+    {
+        try {
+            threads_.reserve(threadCount);
+            for (unsigned int i = 0; i < threadCount; ++i) {
+                threads_.emplace_back(&fork_join_pool::worker_thread, this, i + 1);
+            }
+        } catch (...) {
+            shut_down();
+            throw;
+        }
+    }
+
+    fork_join_pool(const fork_join_pool&) = delete;
+    fork_join_pool& operator=(const fork_join_pool&) = delete;
+    fork_join_pool(fork_join_pool&&) = delete;
+    fork_join_pool& operator=(fork_join_pool&&) = delete;
+
+    ~fork_join_pool() noexcept
+    {
+        shut_down();
+    }
+
+    /// Returns the number of worker threads (not counting the calling thread).
+    [[nodiscard]] std::size_t thread_count() const noexcept
+    {
+        return threads_.size();
+    }
+
+    /**
+     *  Calls `task(i)` for every `i` in the range `[0, taskCount)`, and
+     *  waits for all calls to complete.
+     *
+     *  The calling thread participates in the work.  If any of the calls
+     *  throw, the first exception caught is rethrown here after all tasks
+     *  have completed.
+     */
+    template<typename F>
+    void run(std::size_t taskCount, F&& task)
+    {
+        using task_type = std::remove_reference_t<F>;
+        job_.invoke = [](void* context, std::size_t index) {
+            (*static_cast<task_type*>(context))(index);
+        };
+        job_.context = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+        job_.taskCount = taskCount;
+        error_ = nullptr;
+
+        if (!threads_.empty()) {
+            pending_.store(static_cast<unsigned int>(threads_.size()), std::memory_order_relaxed);
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            if (parkedWorkers_.load(std::memory_order_seq_cst) > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                workerCv_.notify_all();
+            }
+        }
+
+        run_share(0);
+
+        if (!threads_.empty()) wait_for_workers();
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    struct job
+    {
+        void (*invoke)(void*, std::size_t) = nullptr;
+        void* context = nullptr;
+        std::size_t taskCount = 0;
+    };
+
+    // Runs the tasks assigned to the given participant.
+    void run_share(std::size_t participant) noexcept
+    {
+        const auto stride = threads_.size() + 1;
+        for (auto i = participant; i < job_.taskCount; i += stride) {
+            try {
+                job_.invoke(job_.context, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+        }
+    }
+
+    void worker_thread(std::size_t participant)
+    {
+        std::uint64_t seenEpoch = 0;
+        while (true) {
+            // Spin for a while, then park until a new job is published.
+            auto epoch = epoch_.load(std::memory_order_acquire);
+            for (unsigned int s = 0; epoch == seenEpoch && s < spinCount_; ++s) {
+                cpu_relax();
+                epoch = epoch_.load(std::memory_order_acquire);
+            }
+            if (epoch == seenEpoch) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                parkedWorkers_.fetch_add(1, std::memory_order_seq_cst);
+                workerCv_.wait(lock, [&] {
+                    epoch = epoch_.load(std::memory_order_seq_cst);
+                    return epoch != seenEpoch;
+                });
+                parkedWorkers_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            seenEpoch = epoch;
+            if (done_.load(std::memory_order_acquire)) break;
+
+            run_share(participant);
+
+            if (pending_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+                callerParked_.load(std::memory_order_seq_cst)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                callerCv_.notify_one();
+            }
+        }
+    }
+
+    void wait_for_workers()
+    {
+        for (unsigned int s = 0; s < spinCount_; ++s) {
+            if (pending_.load(std::memory_order_acquire) == 0) return;
+            cpu_relax();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        callerParked_.store(true, std::memory_order_seq_cst);
+        callerCv_.wait(lock, [this] {
+            return pending_.load(std::memory_order_seq_cst) == 0;
+        });
+        callerParked_.store(false, std::memory_order_relaxed);
+    }
+
+    void shut_down() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.store(true, std::memory_order_release);
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        workerCv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    const unsigned int spinCount_;
+    std::vector<std::thread> threads_;
+
+    // The current job.  Written by the caller before `epoch_` is bumped,
+    // and only read by the workers after they have observed the new epoch.
+    job job_;
+    std::exception_ptr error_;
+    std::mutex errorMutex_;
+
+    std::atomic<std::uint64_t> epoch_ = 0;
+    std::atomic<unsigned int> pending_ = 0;
+    std::atomic<unsigned int> parkedWorkers_ = 0;
+    std::atomic<bool> callerParked_ = false;
+    std::atomic<bool> done_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable workerCv_;
+    std::condition_variable callerCv_;
+};
+
+} // namespace utility
+} // namespace cosim
+
+#endif // COSIM_UTILITY_FORK_JOIN_POOL_HPP
@@ -5,15 +5,31 @@
  */
 #include "cosim/utility/zip.hpp"
 
+#include "cosim/utility/thread_pool.hpp"
+
+#include <gsl/util>
 #include <zip.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
-#include <fstream>
+#include <exception>
+#include <limits>
+#include <new>
 #include <system_error>
 #include <vector>
 
+#ifdef _WIN32
+#    include <fstream>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/types.h>
+#    include <unistd.h>
+#endif
+
 
 namespace cosim
 {
@@ -81,6 +97,7 @@ archive::archive(const cosim::filesystem::path& path)
 
 archive::archive(archive&& other) noexcept
     : m_archive{other.m_archive}
+    , m_path{std::move(other.m_path)}
 {
     other.m_archive = nullptr;
 }
@@ -90,6 +107,7 @@ archive& archive::operator=(archive&& other) noexcept
 {
     discard();
     m_archive = other.m_archive;
+    m_path = std::move(other.m_path);
     other.m_archive = nullptr;
     return *this;
 }
@@ -114,6 +132,7 @@ void archive::open(const cosim::filesystem::path& path)
         throw error("Unzipping of file: '" + path.string() + "' failed with error: " + errorMsg);
     }
     m_archive = archive;
+    m_path = path;
 }
 
 
@@ -129,6 +148,7 @@ void archive::discard() noexcept
     if (m_archive) {
         zip_discard(m_archive);
         m_archive = nullptr;
+        m_path.clear();
     }
 }
 
@@ -192,31 +212,95 @@ bool archive::is_dir_entry(entry_index index) const
 
 namespace
 {
-void copy_to_stream(
-    auto_zip_file& source,
-    std::ostream& target,
-    std::vector<char>& buffer)
+// The size of the blocks in which entries are decompressed, and the
+// alignment of the buffer that holds them when writing through it.
+constexpr std::size_t block_size = 1 << 20;
+constexpr std::size_t buffer_alignment = 4096;
+
+
+// A fixed-size, page-aligned buffer.
+class aligned_buffer
 {
-    assert(target.good());
-    assert(!buffer.empty());
-    for (;;) {
-        const auto n = source.read(buffer.data(), buffer.size());
+public:
+    explicit aligned_buffer(std::size_t size)
+        : m_data{static_cast<char*>(::operator new(size, std::align_val_t(buffer_alignment)))}
+        , m_size{size}
+    {
+    }
+
+    aligned_buffer(const aligned_buffer&) = delete;
+    aligned_buffer& operator=(const aligned_buffer&) = delete;
+    aligned_buffer(aligned_buffer&&) = delete;
+    aligned_buffer& operator=(aligned_buffer&&) = delete;
+
+    ~aligned_buffer() noexcept
+    {
+        ::operator delete(m_data, std::align_val_t(buffer_alignment));
+    }
+
+    char* data() noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+
+private:
+    char* m_data;
+    std::size_t m_size;
+};
+
+
+struct zip_stat stat_entry(::zip* archive, entry_index index)
+{
+    struct zip_stat zs;
+    if (zip_stat_index(archive, index, 0, &zs)) {
+        throw error(archive);
+    }
+    if (!(zs.valid & ZIP_STAT_NAME) || !(zs.valid & ZIP_STAT_SIZE)) {
+        throw error("Cannot determine entry name and size");
+    }
+    return zs;
+}
+
+
+// Reads up to `size` bytes from `source` into `target`, in blocks, and
+// returns the number of bytes read.
+std::uint64_t read_fully(auto_zip_file& source, char* target, std::uint64_t size)
+{
+    std::uint64_t total = 0;
+    while (total < size) {
+        const auto n = source.read(
+            target + total,
+            static_cast<std::size_t>(std::min<std::uint64_t>(size - total, block_size)));
         if (n == 0) break;
-        target.write(buffer.data(), n);
+        total += n;
     }
+    return total;
 }
 
-void extract_file_as(
-    ::zip* archive,
-    entry_index index,
-    const cosim::filesystem::path& targetPath,
-    std::vector<char>& buffer)
+
+// Verifies that `source` contained exactly `expectedSize` bytes, given that
+// `actualSize` bytes have been read from it.  The final read also lets
+// libzip verify the entry's checksum.
+void check_entry_size(
+    auto_zip_file& source,
+    std::uint64_t expectedSize,
+    std::uint64_t actualSize,
+    const cosim::filesystem::path& targetPath)
 {
-    assert(archive != nullptr);
-    assert(!targetPath.empty());
-    assert(!buffer.empty());
+    char extra;
+    if (actualSize != expectedSize || source.read(&extra, 1) != 0) {
+        throw error(
+            "Archive entry size does not match its recorded size: " + targetPath.string());
+    }
+}
 
-    auto_zip_file srcFile(archive, index, 0);
+
+#ifdef _WIN32
+
+void write_file(
+    auto_zip_file& source,
+    std::uint64_t size,
+    const cosim::filesystem::path& targetPath,
+    aligned_buffer& buffer)
+{
     std::ofstream tgtFile(
         targetPath.string(),
         std::ios_base::binary | std::ios_base::trunc);
@@ -226,18 +310,145 @@ void extract_file_as(
             std::generic_category(),
             targetPath.string());
     }
-    copy_to_stream(srcFile, tgtFile, buffer);
+    std::uint64_t total = 0;
+    for (;;) {
+        const auto n = read_fully(source, buffer.data(), buffer.size());
+        if (n == 0) break;
+        tgtFile.write(buffer.data(), static_cast<std::streamsize>(n));
+        total += n;
+    }
     if (tgtFile.fail()) {
         throw std::system_error(
             make_error_code(std::errc::io_error),
             targetPath.string());
     }
+    check_entry_size(source, size, total, targetPath);
+}
+
+#else
+
+// Reserves disk space for `size` bytes in the file, and returns whether
+// this was supported.  When it was, the file size has also been set.
+bool preallocate(int fd, std::uint64_t size, const cosim::filesystem::path& targetPath)
+{
+#    ifdef __linux__
+    const int result = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (result == 0) return true;
+    if (result != EINVAL && result != EOPNOTSUPP) {
+        throw std::system_error(result, std::generic_category(), targetPath.string());
+    }
+#    else
+    (void)fd;
+    (void)size;
+    (void)targetPath;
+#    endif
+    return false;
+}
+
+
+void write_fully(int fd, const char* data, std::size_t size, const cosim::filesystem::path& targetPath)
+{
+    while (size > 0) {
+        const auto n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), targetPath.string());
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+
+void write_file(
+    auto_zip_file& source,
+    std::uint64_t size,
+    const cosim::filesystem::path& targetPath,
+    aligned_buffer& buffer)
+{
+    const int fd = ::open(targetPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), targetPath.string());
+    }
+    const auto closeFile = gsl::finally([fd] { ::close(fd); });
+
+    // When the space has been reserved, the entry is decompressed straight
+    // into a mapping of the file, so it passes through memory only once.
+    // Without preallocation, a full disk would be reported as a SIGBUS
+    // rather than an error, so then we write through the buffer instead.
+    if (size > 0 &&
+        size <= std::numeric_limits<std::size_t>::max() &&
+        preallocate(fd, size, targetPath)) {
+        const auto mapSize = static_cast<std::size_t>(size);
+        void* map = ::mmap(nullptr, mapSize, PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            const auto unmapFile = gsl::finally([map, mapSize] { ::munmap(map, mapSize); });
+            ::madvise(map, mapSize, MADV_SEQUENTIAL);
+            const auto n = read_fully(source, static_cast<char*>(map), size);
+            check_entry_size(source, size, n, targetPath);
+            return;
+        }
+    }
+
+    std::uint64_t total = 0;
+    for (;;) {
+        const auto n = read_fully(source, buffer.data(), buffer.size());
+        if (n == 0) break;
+        write_fully(fd, buffer.data(), static_cast<std::size_t>(n), targetPath);
+        total += n;
+    }
+    check_entry_size(source, size, total, targetPath);
+}
+
+#endif // _WIN32
+
+
+void extract_file_as(
+    ::zip* archive,
+    entry_index index,
+    std::uint64_t size,
+    const cosim::filesystem::path& targetPath,
+    aligned_buffer& buffer)
+{
+    assert(archive != nullptr);
+    assert(!targetPath.empty());
+
+    auto_zip_file srcFile(archive, index, 0);
+    write_file(srcFile, size, targetPath, buffer);
+}
+
+
+struct file_entry
+{
+    entry_index index;
+    std::uint64_t size;
+    cosim::filesystem::path targetPath;
+};
+
+
+void extract_files_as(::zip* archive, const std::vector<file_entry>& files)
+{
+    auto buffer = aligned_buffer(block_size);
+    for (const auto& file : files) {
+        extract_file_as(archive, file.index, file.size, file.targetPath, buffer);
+    }
 }
 } // namespace
 
 
 void archive::extract_all(
-    const cosim::filesystem::path& targetDir) const
+    const cosim::filesystem::path& targetDir,
+    unsigned int maxThreads) const
+{
+    extract_matching(targetDir, nullptr, maxThreads);
+}
+
+
+void archive::extract_matching(
+    const cosim::filesystem::path& targetDir,
+    const entry_filter& filter,
+    unsigned int maxThreads,
+    std::uint64_t parallelThreshold) const
 {
     assert(is_open());
     if (!cosim::filesystem::exists(targetDir) ||
@@ -247,24 +458,77 @@ void archive::extract_all(
             targetDir.string());
     }
 
-    auto buffer = std::vector<char>(4096 * 16);
+    // Create the directory structure and make a list of the files to
+    // extract, so the extraction itself only touches the files.
+    std::vector<file_entry> files;
+    std::uint64_t totalSize = 0;
     const auto entryCount = entry_count();
     for (entry_index index = 0; index < entryCount; ++index) {
-        const auto entryName = entry_name(index);
-        if (!entryName.empty()) {
-            const auto entryPath = cosim::filesystem::path(entryName);
-            if (entryPath.has_root_path()) {
+        const auto zs = stat_entry(m_archive, index);
+        const auto entryName = std::string(zs.name);
+        if (entryName.empty() || (filter && !filter(entryName))) continue;
+
+        const auto entryPath = cosim::filesystem::path(entryName);
+        if (entryPath.has_root_path()) {
+            throw error(
+                "Archive contains an entry with an absolute path: " + entryName);
+        }
+        for (const auto& component : entryPath) {
+            if (component == "..") {
                 throw error(
-                    "Archive contains an entry with an absolute path: " + entryName);
-            }
-            const auto targetPath = targetDir / entryPath;
-            if (entryName.back() == '/') {
-                cosim::filesystem::create_directories(targetPath);
-            } else {
-                cosim::filesystem::create_directories(targetPath.parent_path());
-                extract_file_as(m_archive, index, targetPath, buffer);
+                    "Archive contains an entry with a '..' path component: " + entryName);
             }
         }
+        const auto targetPath = targetDir / entryPath;
+        if (entryName.back() == '/') {
+            cosim::filesystem::create_directories(targetPath);
+        } else {
+            cosim::filesystem::create_directories(targetPath.parent_path());
+            files.push_back({index, zs.size, targetPath});
+            totalSize += zs.size;
+        }
+    }
+
+    const auto threadCount = std::min<std::size_t>(maxThreads, files.size());
+    if (threadCount <= 1 || totalSize < parallelThreshold) {
+        extract_files_as(m_archive, files);
+        return;
+    }
+
+    // libzip handles can't be shared between threads, so each thread opens
+    // the archive separately.  The largest files are handed out first, to
+    // keep the threads evenly loaded towards the end.
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) {
+        return a.size > b.size;
+    });
+    std::atomic<std::size_t> nextFile = 0;
+    std::vector<std::exception_ptr> errors(threadCount);
+    {
+        auto pool = utility::thread_pool(static_cast<unsigned int>(threadCount));
+        for (std::size_t t = 0; t < threadCount; ++t) {
+            pool.submit([&, t] {
+                try {
+                    const auto threadArchive = archive(m_path);
+                    auto buffer = aligned_buffer(block_size);
+                    for (auto i = nextFile++; i < files.size(); i = nextFile++) {
+                        const auto& file = files[i];
+                        extract_file_as(
+                            threadArchive.m_archive,
+                            file.index,
+                            file.size,
+                            file.targetPath,
+                            buffer);
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                    nextFile = files.size();
+                }
+            });
+        }
+        pool.wait_for_tasks_to_finish();
+    }
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
     }
 }
 
@@ -274,10 +538,11 @@ cosim::filesystem::path archive::extract_file_to(
     const cosim::filesystem::path& targetDir) const
 {
     assert(is_open());
-    const auto entryPath = cosim::filesystem::path(entry_name(index));
+    const auto zs = stat_entry(m_archive, index);
+    const auto entryPath = cosim::filesystem::path(zs.name);
     const auto targetPath = targetDir / entryPath.filename();
-    auto buffer = std::vector<char>(4096 * 16);
-    extract_file_as(m_archive, index, targetPath, buffer);
+    auto buffer = aligned_buffer(block_size);
+    extract_file_as(m_archive, index, zs.size, targetPath, buffer);
     return targetPath;
 }
 
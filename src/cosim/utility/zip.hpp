@@ -14,7 +14,9 @@
 #include <cosim/fs_portability.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 
 
 // Forward declarations to avoid dependency on zip.h
@@ -46,6 +48,21 @@ using entry_index = std::uint64_t;
 constexpr entry_index invalid_entry_index = 0xFFFFFFFFFFFFFFFFull;
 
 
+/**
+ *  The default minimum total size of the files to extract, in bytes, for
+ *  extraction to be distributed between several threads.
+ *  \see archive::extract_matching
+ */
+constexpr std::uint64_t default_parallel_extraction_threshold = 16 << 20;
+
+
+/**
+ *  A predicate which selects archive entries by their full names.
+ *  \see archive::extract_matching
+ */
+using entry_filter = std::function<bool(std::string_view entryName)>;
+
+
 /**
  *  A class for reading ZIP archives.
  *
@@ -182,14 +199,61 @@ public:
      *
      *  \param [in] targetDir
      *      The directory to which the files should be extracted.
+     *  \param [in] maxThreads
+     *      The maximum number of threads used to extract files concurrently.
+     *      See `extract_matching()`.
      *  \throws cosim::utility::zip::error
-     *      If there was an error accessing the archive.
+     *      If there was an error accessing the archive, or if it contains
+     *      an entry with an absolute path or a `..` path component.
+     *  \throws std::system_error
+     *      On I/O error.
+     *  \pre
+     *      `is_open() == true`
+     */
+    void extract_all(
+        const cosim::filesystem::path& targetDir,
+        unsigned int maxThreads = 1) const;
+
+    /**
+     *  Extracts the entries whose names match a filter.
+     *
+     *  This works like `extract_all()`, except that only the entries for
+     *  which `filter` returns `true` are extracted.  The directories that
+     *  contain them are created as needed.
+     *
+     *  Each file is preallocated to its full size where the platform
+     *  supports it, and written in large blocks (or, on POSIX systems,
+     *  decompressed directly into a memory mapping of the file).  If
+     *  `maxThreads` is greater than 1 and the total size of the files is
+     *  at least `parallelThreshold`, the files are distributed by size
+     *  between several threads, each of which reads from a separate handle
+     *  to the archive.
+     *
+     *  \param [in] targetDir
+     *      The directory to which the files should be extracted.
+     *  \param [in] filter
+     *      A predicate which is called with the full name of each entry,
+     *      and which returns whether the entry should be extracted.  If
+     *      empty, all entries are extracted.
+     *  \param [in] maxThreads
+     *      The maximum number of threads used to extract files concurrently.
+     *  \param [in] parallelThreshold
+     *      The minimum total size of the files, in bytes, for them to be
+     *      extracted by more than one thread.
+     *  \throws cosim::utility::zip::error
+     *      If there was an error accessing the archive, or if one of the
+     *      matching entries has an absolute path or a `..` path component.
+     *      This is checked before the entry's directories are created.
      *  \throws std::system_error
      *      On I/O error.
      *  \pre
      *      `is_open() == true`
      */
-    void extract_all(const cosim::filesystem::path& targetDir) const;
+    void extract_matching(
+        const cosim::filesystem::path& targetDir,
+        const entry_filter& filter,
+        unsigned int maxThreads = 1,
+        std::uint64_t parallelThreshold = default_parallel_extraction_threshold) const;
 
     /**
      *  Extracts a single file from the archive, placing it in a specific
@@ -219,6 +283,7 @@ public:
 
 private:
     ::zip* m_archive;
+    cosim::filesystem::path m_path;
 };
 
 
@@ -0,0 +1,189 @@
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm.hpp>
+#include <cosim/execution.hpp>
+#include <cosim/function/linear_transformation.hpp>
+#include <cosim/log/simple.hpp>
+#include <cosim/time.hpp>
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+// A helper macro to test various assertions
+#define REQUIRE(test) \
+    if (!(test)) throw std::runtime_error("Requirement not satisfied: " #test)
+
+
+namespace
+{
+constexpr cosim::time_point endTime = cosim::to_time_point(1.0);
+constexpr int slaveCount = 6;
+
+// A slave whose state is a first-order lag of its real input, and whose
+// real output is its state plus an offset.
+class lag_slave : public mock_slave
+{
+public:
+    explicit lag_slave(double offset)
+        : mock_slave([this, offset](double) { return state_ + offset; })
+    {
+    }
+
+    cosim::step_result do_step(cosim::time_point currentT, cosim::duration deltaT) override
+    {
+        const cosim::value_reference ref = real_in_reference;
+        double input = 0.0;
+        get_real_variables(gsl::make_span(&ref, 1), gsl::make_span(&input, 1));
+        state_ += cosim::to_double_duration(deltaT, currentT) * (input - state_);
+        return mock_slave::do_step(currentT, deltaT);
+    }
+
+    double state() const { return state_; }
+
+private:
+    double state_ = 0.0;
+};
+
+struct stepping_mode
+{
+    bool parallelTransfers = false;
+    bool pipelined = false;
+};
+
+// Adds a system of lag slaves and linear transformation functions, connected
+// in a ring as well as in a branch, to `execution`, and returns the slaves.
+std::vector<std::shared_ptr<lag_slave>> add_system(cosim::execution& execution)
+{
+    std::vector<std::shared_ptr<lag_slave>> slaves;
+    std::vector<cosim::simulator_index> indices;
+    for (int k = 0; k < slaveCount; ++k) {
+        slaves.push_back(std::make_shared<lag_slave>(0.1 * k));
+        indices.push_back(execution.add_slave(slaves.back(), "slave " + std::to_string(k)));
+    }
+    const auto out = [&](int k) {
+        return cosim::variable_id{indices[k], cosim::variable_type::real, mock_slave::real_out_reference};
+    };
+    const auto in = [&](int k) {
+        return cosim::variable_id{indices[k], cosim::variable_type::real, mock_slave::real_in_reference};
+    };
+    const auto connect_through_function = [&](int from, int to, double offset, double factor) {
+        const auto f = execution.add_function(
+            std::make_shared<cosim::linear_transformation_function>(offset, factor));
+        execution.connect_variables(
+            out(from),
+            cosim::function_io_id{f, cosim::variable_type::real, cosim::linear_transformation_function::in_io_reference});
+        execution.connect_variables(
+            cosim::function_io_id{f, cosim::variable_type::real, cosim::linear_transformation_function::out_io_reference},
+            in(to));
+    };
+
+    // 0 -> 1 -> 2 -> 3 -> 4 -> f -> 0, and 2 -> f -> 5
+    for (int k = 0; k < 4; ++k) execution.connect_variables(out(k), in(k + 1));
+    connect_through_function(4, 0, 1.0, -0.5);
+    connect_through_function(2, 5, -0.2, 2.0);
+    return slaves;
+}
+
+// Runs the system with a multi-rate `fixed_step_algorithm` and returns the
+// states of all slaves after every step.
+std::vector<double> run_fixed_step(
+    unsigned int threadCount,
+    cosim::worker_pool_type poolType,
+    stepping_mode mode)
+{
+    auto algorithm = std::make_shared<cosim::fixed_step_algorithm>(
+        cosim::to_duration(0.01), threadCount, poolType);
+    algorithm->set_parallel_transfers(mode.parallelTransfers);
+    algorithm->set_pipelined_stepping(mode.pipelined);
+    auto execution = cosim::execution(cosim::time_point(), algorithm);
+    const auto slaves = add_system(execution);
+    const int decimationFactors[slaveCount] = {1, 2, 3, 1, 2, 4};
+    for (int k = 0; k < slaveCount; ++k) {
+        algorithm->set_stepsize_decimation_factor(k, decimationFactors[k]);
+    }
+
+    std::vector<double> trace;
+    while (execution.current_time() < endTime) {
+        execution.step();
+        for (const auto& s : slaves) trace.push_back(s->state());
+    }
+    return trace;
+}
+
+// Runs the system with an `ecco_algorithm`, with a power bond between the
+// first two slaves, and returns the states of all slaves and the step size
+// after every step.
+std::vector<double> run_ecco(
+    unsigned int threadCount,
+    cosim::worker_pool_type poolType,
+    stepping_mode mode)
+{
+    const auto params = cosim::ecco_algorithm_params{
+        0.9,
+        cosim::to_duration(1e-3),
+        cosim::to_duration(1e-4),
+        cosim::to_duration(0.01),
+        0.2,
+        1.5,
+        1e-4,
+        1e-4,
+        0.2,
+        0.15};
+    auto algorithm = std::make_shared<cosim::ecco_algorithm>(params, threadCount, poolType);
+    algorithm->set_parallel_transfers(mode.parallelTransfers);
+    algorithm->set_pipelined_stepping(mode.pipelined);
+    auto execution = cosim::execution(cosim::time_point(), algorithm);
+    const auto slaves = add_system(execution);
+    algorithm->add_power_bond(
+        cosim::variable_id{1, cosim::variable_type::real, mock_slave::real_in_reference},
+        cosim::variable_id{1, cosim::variable_type::real, mock_slave::real_out_reference},
+        cosim::variable_id{0, cosim::variable_type::real, mock_slave::real_in_reference},
+        cosim::variable_id{0, cosim::variable_type::real, mock_slave::real_out_reference});
+
+    std::vector<double> trace;
+    while (execution.current_time() < endTime) {
+        trace.push_back(cosim::to_double_duration(execution.step(), {}));
+        for (const auto& s : slaves) trace.push_back(s->state());
+    }
+    return trace;
+}
+} // namespace
+
+
+int main()
+{
+    try {
+        cosim::log::setup_simple_console_logging();
+        cosim::log::set_global_output_level(cosim::log::info);
+
+        // The results of every combination of worker pool and stepping mode
+        // must be identical to those of a single thread in the default mode.
+        const auto fixedStepReference = run_fixed_step(1, cosim::worker_pool_type::task_queue, {});
+        const auto eccoReference = run_ecco(1, cosim::worker_pool_type::task_queue, {});
+        REQUIRE(!fixedStepReference.empty());
+        REQUIRE(!eccoReference.empty());
+
+        // The thread counts cover both fewer and more workers than there
+        // are simulators.
+        for (const auto poolType : {cosim::worker_pool_type::task_queue, cosim::worker_pool_type::fork_join}) {
+            for (const unsigned int threadCount : {2u, 4u, 8u}) {
+                for (const bool parallelTransfers : {false, true}) {
+                    for (const bool pipelined : {false, true}) {
+                        const auto mode = stepping_mode{parallelTransfers, pipelined};
+                        REQUIRE(run_fixed_step(threadCount, poolType, mode) == fixedStepReference);
+                        REQUIRE(run_ecco(threadCount, poolType, mode) == eccoReference);
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
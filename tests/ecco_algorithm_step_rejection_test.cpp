@@ -0,0 +1,127 @@
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm.hpp>
+#include <cosim/log/simple.hpp>
+#include <cosim/manipulator/override_manipulator.hpp>
+#include <cosim/time.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+
+// A helper macro to test various assertions
+#define REQUIRE(test) \
+    if (!(test)) throw std::runtime_error("Requirement not satisfied: " #test)
+
+
+namespace
+{
+constexpr double tolerance = 1e-6;
+
+// The output of simulator A, whose rate of change increases tenfold at t = 0.2
+double output_a(double t)
+{
+    return t < 0.2 ? t : 0.2 + 10.0 * (t - 0.2);
+}
+
+// Runs a system of two simulators connected by a power bond, where the power
+// residual in each step is the change in `output_a()` during the step, and
+// returns the largest error estimate of any step that was accepted.  If
+// `overrideUntil` is given, an unrelated input of B is overridden until that
+// time, which prevents the simulators from saving their states.
+double run(bool stepRejection, std::int64_t& rejectedSteps, std::optional<double> overrideUntil = std::nullopt)
+{
+    const auto ecco_params = cosim::ecco_algorithm_params{
+        0.9,
+        cosim::to_duration(1e-4),
+        cosim::to_duration(1e-6),
+        cosim::to_duration(0.01),
+        0.2,
+        1.5,
+        tolerance,
+        tolerance,
+        0.2,
+        0.15};
+    auto ecco_algo = std::make_shared<cosim::ecco_algorithm>(ecco_params);
+    ecco_algo->set_step_rejection(stepRejection);
+    auto execution = cosim::execution(cosim::time_point(), ecco_algo);
+
+    // The output of B is 1.  Each side's power is the product of its input
+    // and output, and the inputs lag one step behind the outputs.
+    const auto a = execution.add_slave(
+        std::make_unique<mock_slave>([](cosim::time_point t, cosim::duration, double) {
+            return output_a(cosim::to_double_time_point(t));
+        }),
+        "A");
+    const auto b = execution.add_slave(
+        std::make_unique<mock_slave>([](double) { return 1.0; }),
+        "B");
+
+    const auto outA = cosim::variable_id{a, cosim::variable_type::real, mock_slave::real_out_reference};
+    const auto inA = cosim::variable_id{a, cosim::variable_type::real, mock_slave::real_in_reference};
+    const auto outB = cosim::variable_id{b, cosim::variable_type::real, mock_slave::real_out_reference};
+    const auto inB = cosim::variable_id{b, cosim::variable_type::real, mock_slave::real_in_reference};
+    execution.connect_variables(outA, inB);
+    execution.connect_variables(outB, inA);
+    ecco_algo->add_power_bond(inA, outA, inB, outB);
+
+    auto manipulator = std::make_shared<cosim::override_manipulator>();
+    execution.add_manipulator(manipulator);
+    if (overrideUntil) {
+        manipulator->override_integer_variable(b, mock_slave::integer_in_reference, 1);
+    }
+
+    double t = cosim::to_double_duration(execution.step(), {});
+    double maxErrorEstimate = 0.0;
+    while (t < 0.3) {
+        if (overrideUntil && t >= *overrideUntil) {
+            manipulator->reset_variable(b, cosim::variable_type::integer, mock_slave::integer_in_reference);
+            overrideUntil.reset();
+        }
+        const auto dt = cosim::to_double_duration(execution.step(), {});
+        const auto energyResidual = (output_a(t + dt) - output_a(t)) * dt;
+        maxErrorEstimate = std::max(maxErrorEstimate, energyResidual / (tolerance * (1.0 + energyResidual)));
+        t += dt;
+    }
+    rejectedSteps = ecco_algo->get_rejected_step_count();
+    return maxErrorEstimate;
+}
+} // namespace
+
+
+int main()
+{
+    try {
+        cosim::log::setup_simple_console_logging();
+        cosim::log::set_global_output_level(cosim::log::info);
+
+        // Without step rejection, the step in which the rate of change
+        // increases is accepted even though the error is far too large.
+        std::int64_t rejectedSteps = 0;
+        REQUIRE(run(false, rejectedSteps) > 2.0);
+        REQUIRE(rejectedSteps == 0);
+
+        // With step rejection, that step is retried until the error is
+        // within the tolerance.
+        REQUIRE(run(true, rejectedSteps) <= 1.0 + 1e-6);
+        REQUIRE(rejectedSteps > 0);
+
+        // While a variable is overridden, states can't be saved, so steps
+        // are accepted regardless of their error estimate.
+        REQUIRE(run(true, rejectedSteps, 1.0) > 2.0);
+        REQUIRE(rejectedSteps == 0);
+
+        // Once the override is reset, steps are rejected again.
+        REQUIRE(run(true, rejectedSteps, 0.1) <= 1.0 + 1e-6);
+        REQUIRE(rejectedSteps > 0);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,8 +6,11 @@
 #include <cosim/observer/time_series_observer.hpp>
 #include <cosim/time.hpp>
 
+#include <cmath>
+#include <cstdint>
 #include <exception>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 
 
@@ -98,6 +101,8 @@ int main()
         execution.connect_variables(output2, input1);
 
         ecco_algo->add_power_bond(input1, output1, input2, output2);
+        constexpr std::size_t energyWindowSize = 100;
+        ecco_algo->set_energy_window_size(energyWindowSize);
 
         execution.set_real_initial_value(slaves[0], realInRef, 0.5);
 
@@ -113,6 +118,16 @@ int main()
         auto simResult = execution.simulate_until(midTime);
         REQUIRE(simResult);
 
+        // Energies are accumulated over all steps, but only retained for
+        // the most recent ones.
+        const auto energyStats = ecco_algo->get_powerbond_energy_stats(0);
+        REQUIRE(energyStats.step_count > static_cast<std::int64_t>(energyWindowSize));
+        REQUIRE(std::abs(energyStats.mean * energyStats.step_count - energyStats.total) < 1e-9 * (1.0 + std::abs(energyStats.total)));
+        const auto recentEnergies = ecco_algo->get_powerbond_energies(0);
+        REQUIRE(recentEnergies.size() == energyWindowSize);
+        const auto recentTotal = std::accumulate(recentEnergies.begin(), recentEnergies.end(), 0.0);
+        REQUIRE(std::abs(recentTotal / energyWindowSize - energyStats.window_mean) < 1e-12);
+
         cosim::step_number stepNums[2];
         t_observer->get_step_numbers(slaves[0], {}, midTime, gsl::make_span(stepNums, 2));
         const auto numSamples = stepNums[1] - stepNums[0];
@@ -166,6 +181,18 @@ int main()
                       << "," << real_b_output[i]
                       << std::endl;
         }
+
+        // The algorithm state, including the accumulated energies, can be
+        // exported and restored.
+        const auto algorithmState = ecco_algo->export_current_state();
+        REQUIRE(execution.simulate_until(midTime + cosim::to_duration(1.0)));
+        REQUIRE(ecco_algo->get_powerbond_energy_stats(0).step_count > energyStats.step_count);
+        ecco_algo->import_state(algorithmState);
+        const auto restoredStats = ecco_algo->get_powerbond_energy_stats(1);
+        REQUIRE(restoredStats.step_count == energyStats.step_count);
+        REQUIRE(ecco_algo->get_powerbond_energy_stats(0).total == energyStats.total);
+        REQUIRE(ecco_algo->get_powerbond_energies(0) == recentEnergies);
+        REQUIRE(ecco_algo->export_current_state() == algorithmState);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
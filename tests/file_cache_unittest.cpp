@@ -0,0 +1,51 @@
+#define BOOST_TEST_MODULE file_cache.hpp unittests
+#include <cosim/file_cache.hpp>
+#include <cosim/fs_portability.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <optional>
+#include <string>
+
+
+BOOST_TEST_DONT_PRINT_LOG_VALUE(std::optional<std::string>)
+
+
+BOOST_AUTO_TEST_CASE(persistent_file_cache_index)
+{
+    const auto root = cosim::filesystem::temp_directory_path() / "libcosim_file_cache_unittest";
+    cosim::filesystem::remove_all(root);
+
+    // Longer than the maximum file name length on most file systems
+    const auto longKey = "file:" + std::string(1000, 'x');
+    {
+        auto cache = cosim::persistent_file_cache(root);
+        BOOST_TEST(cache.has_index());
+        BOOST_TEST(!cache.get_index_entry("foo"));
+        cache.set_index_entry("foo", "bar baz");
+        cache.set_index_entry("file:/some path\nwith newline", "1 2 3");
+        cache.set_index_entry("foo", "qux");
+        cache.set_index_entry(longKey, "long");
+    }
+    {
+        // The index persists across cache objects.
+        auto cache = cosim::persistent_file_cache(root);
+        BOOST_TEST(cache.get_index_entry("foo") == std::optional<std::string>("qux"));
+        BOOST_TEST(cache.get_index_entry("file:/some path\nwith newline") == std::optional<std::string>("1 2 3"));
+        BOOST_TEST(cache.get_index_entry(longKey) == std::optional<std::string>("long"));
+
+        // Cleaning up the cache clears the index.
+        cache.cleanup();
+        BOOST_TEST(!cache.get_index_entry("foo"));
+    }
+    cosim::filesystem::remove_all(root);
+}
+
+
+BOOST_AUTO_TEST_CASE(temporary_file_cache_has_no_index)
+{
+    auto cache = cosim::temporary_file_cache();
+    BOOST_TEST(!cache.has_index());
+    cache.set_index_entry("foo", "bar");
+    BOOST_TEST(!cache.get_index_entry("foo"));
+}
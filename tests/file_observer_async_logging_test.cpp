@@ -0,0 +1,99 @@
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm.hpp>
+#include <cosim/execution.hpp>
+#include <cosim/fs_portability.hpp>
+#include <cosim/log/simple.hpp>
+#include <cosim/observer/file_observer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+
+// A helper macro to test various assertions
+#define REQUIRE(test) \
+    if (!(test)) throw std::runtime_error("Requirement not satisfied: " #test)
+
+
+std::string read_file(const cosim::filesystem::path& path)
+{
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+
+int main()
+{
+    try {
+        cosim::log::setup_simple_console_logging();
+        cosim::log::set_global_output_level(cosim::log::info);
+
+        constexpr cosim::time_point startTime = cosim::to_time_point(0.0);
+        constexpr cosim::time_point endTime = cosim::to_time_point(10.0);
+        constexpr cosim::duration stepSize = cosim::to_duration(0.1);
+        constexpr std::int64_t rowCount = 101; // Including the initial values
+
+        const auto logPath = cosim::filesystem::current_path() / "logs" / "async";
+        cosim::filesystem::remove_all(logPath);
+
+        const auto config = cosim::file_observer_config()
+                                .set_timestamped_filenames(false)
+                                .log_all_simulator_variables("slave");
+        auto syncObserver = std::make_shared<cosim::file_observer>(
+            logPath / "sync",
+            config);
+        auto blockingObserver = std::make_shared<cosim::file_observer>(
+            logPath / "block",
+            cosim::file_observer_config(config).set_asynchronous_writing(4));
+        auto droppingObserver = std::make_shared<cosim::file_observer>(
+            logPath / "drop",
+            cosim::file_observer_config(config).set_asynchronous_writing(1, cosim::file_observer_overflow_policy::drop));
+
+        auto execution = cosim::execution(startTime, std::make_unique<cosim::fixed_step_algorithm>(stepSize));
+        execution.add_observer(syncObserver);
+        execution.add_observer(blockingObserver);
+        execution.add_observer(droppingObserver);
+        execution.add_slave(
+            std::make_unique<mock_slave>(
+                [](double x) { return x + 1.234; },
+                [](int y) { return y - 4; },
+                [](bool z) { return !z; },
+                [](std::string_view) { return std::string("hello log"); }),
+            "slave");
+
+        REQUIRE(execution.simulate_until(endTime));
+        syncObserver->stop_recording();
+        blockingObserver->stop_recording();
+        droppingObserver->stop_recording();
+
+        // With the blocking policy, the output is the same as when writing
+        // synchronously.
+        const auto syncOutput = read_file(logPath / "sync" / "slave.csv");
+        REQUIRE(std::count(syncOutput.begin(), syncOutput.end(), '\n') == rowCount + 1);
+        REQUIRE(read_file(logPath / "block" / "slave.csv") == syncOutput);
+        REQUIRE(blockingObserver->get_dropped_sample_count() == 0);
+
+        // With the drop policy, every sample is either written or dropped.
+        const auto dropOutput = read_file(logPath / "drop" / "slave.csv");
+        const auto writtenRows = std::count(dropOutput.begin(), dropOutput.end(), '\n') - 1;
+        REQUIRE(writtenRows + static_cast<std::int64_t>(droppingObserver->get_dropped_sample_count()) == rowCount);
+
+        // Writing resumes when recording is restarted.
+        blockingObserver->start_recording();
+        REQUIRE(execution.simulate_until(endTime + stepSize));
+        blockingObserver->stop_recording();
+        const auto resumedOutput = read_file(logPath / "block" / "slave.csv");
+        REQUIRE(resumedOutput.size() > syncOutput.size());
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
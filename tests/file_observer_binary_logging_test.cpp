@@ -0,0 +1,169 @@
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm.hpp>
+#include <cosim/execution.hpp>
+#include <cosim/fs_portability.hpp>
+#include <cosim/log/simple.hpp>
+#include <cosim/observer/file_observer.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// A helper macro to test various assertions
+#define REQUIRE(test) \
+    if (!(test)) throw std::runtime_error("Requirement not satisfied: " #test)
+
+
+class binary_reader
+{
+public:
+    binary_reader(const std::vector<char>& data, std::size_t pos)
+        : data_(data)
+        , pos_(pos)
+    { }
+
+    template<typename T>
+    T read()
+    {
+        REQUIRE(pos_ + sizeof(T) <= data_.size());
+        T value;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string read_string()
+    {
+        const auto size = read<std::uint32_t>();
+        return read_bytes(size);
+    }
+
+    std::string read_bytes(std::size_t size)
+    {
+        REQUIRE(pos_ + size <= data_.size());
+        auto value = std::string(data_.data() + pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    std::size_t position() const { return pos_; }
+
+    void seek(std::size_t pos) { pos_ = pos; }
+
+private:
+    const std::vector<char>& data_;
+    std::size_t pos_;
+};
+
+
+int main()
+{
+    try {
+        cosim::log::setup_simple_console_logging();
+        cosim::log::set_global_output_level(cosim::log::info);
+
+        constexpr cosim::time_point startTime = cosim::to_time_point(0.0);
+        constexpr cosim::time_point endTime = cosim::to_time_point(10.0);
+        constexpr cosim::duration stepSize = cosim::to_duration(0.1);
+        constexpr std::int64_t stepCount = 100;
+
+        const auto logPath = cosim::filesystem::current_path() / "logs" / "binary";
+        cosim::filesystem::remove_all(logPath);
+
+        auto execution = cosim::execution(startTime, std::make_unique<cosim::fixed_step_algorithm>(stepSize));
+
+        auto config = cosim::file_observer_config()
+                          .set_timestamped_filenames(false)
+                          .log_all_simulator_variables("slave")
+                          .set_output_format(cosim::file_observer_format::binary);
+        auto observer = std::make_shared<cosim::file_observer>(logPath, config);
+        execution.add_observer(observer);
+
+        execution.add_slave(
+            std::make_unique<mock_slave>(
+                [](double x) { return x + 1.5; },
+                [](int y) { return y - 4; },
+                [](bool z) { return !z; }),
+            "slave");
+
+        REQUIRE(execution.simulate_until(endTime));
+        observer->stop_recording();
+
+        const auto filePath = logPath / "slave.bin";
+        REQUIRE(cosim::filesystem::exists(filePath));
+        std::ifstream file(filePath, std::ios_base::binary);
+        const auto data = std::vector<char>(std::istreambuf_iterator<char>(file), {});
+
+        // Trailer
+        REQUIRE(data.size() > 24);
+        auto trailer = binary_reader(data, data.size() - 24);
+        const auto indexOffset = trailer.read<std::uint64_t>();
+        const auto segmentSize = trailer.read<std::uint64_t>();
+        REQUIRE(trailer.read_bytes(8) == "COSIMIDX");
+        REQUIRE(segmentSize == data.size());
+
+        // Header
+        auto reader = binary_reader(data, 0);
+        REQUIRE(reader.read_bytes(8) == "COSIMLOG");
+        REQUIRE(reader.read<std::uint32_t>() == 1);
+        REQUIRE(reader.read<std::uint32_t>() == 0x01020304);
+        REQUIRE(reader.read_string() == "slave");
+        REQUIRE(reader.read_string() == "mock_slave");
+        reader.read_string();
+        std::uint32_t counts[4];
+        for (auto& count : counts) count = reader.read<std::uint32_t>();
+        REQUIRE(counts[0] == 2 && counts[1] == 2 && counts[2] == 2 && counts[3] == 2);
+        std::vector<std::string> names;
+        for (int i = 0; i < 8; ++i) {
+            names.push_back(reader.read_string());
+            reader.read<std::uint32_t>();
+            reader.read_string();
+            reader.read_string();
+        }
+        REQUIRE(names[0] == "realOut" && names[1] == "realIn");
+
+        // Blocks
+        const auto firstBlockOffset = reader.position();
+        std::int64_t rows = 0;
+        std::int64_t lastStep = -1;
+        while (reader.position() < indexOffset) {
+            REQUIRE(reader.read_bytes(4) == "BLCK");
+            const auto blockRows = reader.read<std::uint32_t>();
+            const auto payloadSize = reader.read<std::uint64_t>();
+            const auto payloadStart = reader.position();
+            for (std::uint32_t r = 0; r < blockRows; ++r) {
+                const auto step = reader.read<std::int64_t>();
+                REQUIRE(step == lastStep + 1 || lastStep < 0);
+                lastStep = step;
+            }
+            reader.read_bytes(blockRows * sizeof(std::int64_t));
+            for (std::uint32_t r = 0; r < blockRows; ++r) {
+                // realOut = realIn + 1.5, and realIn is unconnected
+                REQUIRE(reader.read<double>() == 1.5);
+            }
+            reader.seek(payloadStart + payloadSize);
+            rows += blockRows;
+        }
+        REQUIRE(reader.position() == indexOffset);
+        REQUIRE(rows >= stepCount);
+        REQUIRE(lastStep == stepCount);
+
+        // Block index
+        const auto blockCount = reader.read<std::uint64_t>();
+        REQUIRE(blockCount >= 1);
+        REQUIRE(reader.read<std::uint64_t>() == firstBlockOffset);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
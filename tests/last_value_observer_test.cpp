@@ -6,11 +6,13 @@
 #include <cosim/manipulator/override_manipulator.hpp>
 #include <cosim/observer/last_value_observer.hpp>
 
+#include <atomic>
 #include <cmath>
 #include <exception>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 
 // A helper macro to test various assertions
@@ -34,6 +36,9 @@ int main()
         auto observer = std::make_shared<cosim::last_value_observer>();
         execution.add_observer(observer);
 
+        auto selectiveObserver = std::make_shared<cosim::last_value_observer>(false);
+        execution.add_observer(selectiveObserver);
+
         const auto sim = execution.add_slave(
             std::make_unique<mock_slave>(
                 [](double x) { return x + 1.234; },
@@ -111,6 +116,57 @@ int main()
         REQUIRE(stringInValue == "foo");
         REQUIRE(stringOutValue == "foobar");
 
+        // Read values concurrently with stepping, and check that each read
+        // is consistent, i.e., that all values are from the same step.
+        std::atomic<bool> stepping = true;
+        std::atomic<bool> consistent = true;
+        auto reader = std::thread([&] {
+            const cosim::value_reference refs[] = {realInRef, realOutRef};
+            double values[2];
+            while (stepping) {
+                observer->get_real(sim, refs, values);
+                if (std::fabs(values[1] - values[0] - 1.234) > 1.0e-9) consistent = false;
+            }
+        });
+        for (int i = 0; i < 1000; ++i) {
+            manipulator->override_real_variable(sim, realInRef, i);
+            execution.step();
+        }
+        stepping = false;
+        reader.join();
+        REQUIRE(consistent);
+
+        // The selective observer only provides values for the variables it
+        // has been asked to observe, from the step after it was asked.
+        const auto realOutId = cosim::variable_id{sim, cosim::variable_type::real, realOutRef};
+        const auto selectiveRead = [&] {
+            try {
+                selectiveObserver->get_real(sim, gsl::make_span(&realOutRef, 1), gsl::make_span(&realOutValue, 1));
+                return true;
+            } catch (const std::out_of_range&) {
+                return false;
+            }
+        };
+        REQUIRE(!selectiveRead());
+        selectiveObserver->start_observing(realOutId);
+        REQUIRE(!selectiveRead());
+        manipulator->override_real_variable(sim, realInRef, 5.0);
+        execution.step();
+        REQUIRE(selectiveRead());
+        REQUIRE(std::fabs(realOutValue - 6.234) < 1.0e-9);
+        selectiveObserver->stop_observing(realOutId);
+        execution.step();
+        REQUIRE(!selectiveRead());
+
+        // Variables of unsupported types are rejected.
+        bool rejected = false;
+        try {
+            selectiveObserver->start_observing(
+                cosim::variable_id{sim, cosim::variable_type::enumeration, realOutRef});
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        REQUIRE(rejected);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -76,6 +76,8 @@ public:
         cosim::model_description md;
         md.name = "mock_slave";
         md.uuid = "09b7ee06-fc07-4ad0-86f1-cd183fbae519";
+        md.capabilities.can_save_state = true;
+        md.capabilities.can_export_state = true;
         md.variables.push_back(cosim::variable_description{"realOut", real_out_reference, cosim::variable_type::real, cosim::variable_causality::output, cosim::variable_variability::discrete, std::nullopt});
         md.variables.push_back(cosim::variable_description{"realIn", real_in_reference, cosim::variable_type::real, cosim::variable_causality::input, cosim::variable_variability::discrete, 0.0});
         md.variables.push_back(cosim::variable_description{"intOut", integer_out_reference, cosim::variable_type::integer, cosim::variable_causality::output, cosim::variable_variability::discrete, std::nullopt});
@@ -0,0 +1,34 @@
+#define BOOST_TEST_MODULE model_description.hpp unittests
+#include <cosim/model_description.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+
+BOOST_AUTO_TEST_CASE(variable_lookup)
+{
+    using cosim::variable_causality;
+    using cosim::variable_type;
+    using cosim::variable_variability;
+
+    auto md = std::make_shared<cosim::model_description>();
+    md->variables = {
+        {"x", 0, variable_type::real, variable_causality::output, variable_variability::continuous, std::nullopt},
+        {"xAlias", 0, variable_type::real, variable_causality::local, variable_variability::continuous, std::nullopt},
+        {"u", 1, variable_type::real, variable_causality::input, variable_variability::continuous, 0.0},
+        {"n", 0, variable_type::integer, variable_causality::parameter, variable_variability::fixed, 1},
+    };
+    const auto lookup = cosim::variable_lookup(md);
+
+    BOOST_TEST(lookup.find("u") == &md->variables[2]);
+    BOOST_TEST(lookup.find("y") == nullptr);
+
+    BOOST_TEST(lookup.find(variable_type::real, 0) == &md->variables[0]);
+    BOOST_TEST(lookup.find(variable_type::integer, 0) == &md->variables[3]);
+    BOOST_TEST(lookup.find(variable_type::boolean, 0) == nullptr);
+    BOOST_TEST(lookup.find(variable_type::real, 2) == nullptr);
+
+    BOOST_TEST(lookup.find(variable_type::real, 0, variable_causality::local) == &md->variables[1]);
+    BOOST_TEST(lookup.find(variable_type::real, 0, variable_causality::input) == nullptr);
+}
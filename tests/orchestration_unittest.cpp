@@ -5,6 +5,14 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 
 BOOST_AUTO_TEST_CASE(file_uri_sub_resolver_absolute_path_test)
 {
@@ -34,3 +42,121 @@ BOOST_AUTO_TEST_CASE(file_uri_sub_resolver_relative_path_test)
     auto model = resolver.lookup_model(baseUri, "fmi2/vector.fmu");
     BOOST_TEST(model->description()->name == "com.open-simulation-platform.vector");
 }
+
+
+BOOST_AUTO_TEST_CASE(file_uri_sub_resolver_parallel_lookup_test)
+{
+    const auto testDataDir = std::getenv("TEST_DATA_DIR");
+    BOOST_TEST_REQUIRE(!!testDataDir);
+    const auto basePath = cosim::filesystem::path(testDataDir) / "some_base";
+    const auto baseUri = cosim::path_to_file_uri(basePath);
+
+    cosim::model_uri_resolver resolver;
+    resolver.add_sub_resolver(std::make_shared<cosim::fmu_file_uri_sub_resolver>());
+
+    const auto models = resolver.lookup_models(
+        baseUri,
+        {"fmi2/vector.fmu", "fmi2/Dahlquist.fmu", "fmi1/identity.fmu", "fmi2/vector.fmu"},
+        4);
+    BOOST_TEST_REQUIRE(models.size() == 4);
+    BOOST_TEST(models[0]->description()->name == "com.open-simulation-platform.vector");
+    BOOST_TEST(models[1]->description()->name == "Dahlquist");
+    BOOST_TEST(models[2]->description()->name == "no.viproma.demo.identity");
+    BOOST_TEST(models[3] == models[0]);
+}
+
+
+namespace
+{
+class null_model : public cosim::model
+{
+public:
+    std::shared_ptr<const cosim::model_description> description() const noexcept override
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<cosim::slave> instantiate(std::string_view) override
+    {
+        return nullptr;
+    }
+};
+
+// A sub-resolver which records the thread budget it is given.
+class budget_recording_sub_resolver : public cosim::model_uri_sub_resolver
+{
+public:
+    using cosim::model_uri_sub_resolver::lookup_model;
+
+    std::shared_ptr<cosim::model> lookup_model(const cosim::uri&) override
+    {
+        return std::make_shared<null_model>();
+    }
+
+    std::shared_ptr<cosim::model> lookup_model(
+        const cosim::uri& baseUri,
+        const cosim::uri& modelUriReference,
+        unsigned int maxThreads) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budgets.push_back(maxThreads);
+        return lookup_model(baseUri, modelUriReference);
+    }
+
+    bool supports_concurrent_lookups() const noexcept override { return true; }
+
+    std::vector<unsigned int> budgets;
+
+private:
+    std::mutex mutex_;
+};
+
+// A sub-resolver which doesn't support concurrent lookups, declines all
+// URIs, and records whether it was ever called concurrently.
+class serial_declining_sub_resolver : public cosim::model_uri_sub_resolver
+{
+public:
+    std::shared_ptr<cosim::model> lookup_model(const cosim::uri&) override
+    {
+        if (active_.fetch_add(1) != 0) overlapped = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        active_.fetch_sub(1);
+        return nullptr;
+    }
+
+    std::atomic<bool> overlapped = false;
+
+private:
+    std::atomic<int> active_ = 0;
+};
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE(parallel_lookup_thread_budget_test)
+{
+    auto sr = std::make_shared<budget_recording_sub_resolver>();
+    cosim::model_uri_resolver resolver;
+    resolver.add_sub_resolver(sr);
+
+    resolver.lookup_models("file:///base/", {"a.fmu", "b.fmu", "c.fmu", "a.fmu"}, 7);
+    BOOST_TEST(sr->budgets == std::vector<unsigned int>(3, 2));
+
+    sr->budgets.clear();
+    resolver.lookup_models("file:///base/", {"a.fmu", "b.fmu"}, 1);
+    BOOST_TEST(sr->budgets == std::vector<unsigned int>(2, 1));
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_lookup_serial_sub_resolver_test)
+{
+    auto serial = std::make_shared<serial_declining_sub_resolver>();
+    auto concurrent = std::make_shared<budget_recording_sub_resolver>();
+    cosim::model_uri_resolver resolver;
+    resolver.add_sub_resolver(serial);
+    resolver.add_sub_resolver(concurrent);
+
+    const auto models = resolver.lookup_models("file:///base/", {"a.fmu", "b.fmu", "c.fmu", "d.fmu"}, 4);
+    BOOST_TEST(models.size() == 4);
+    BOOST_TEST(!serial->overlapped);
+    BOOST_TEST(concurrent->budgets == std::vector<unsigned int>(4, 1));
+}
@@ -1,6 +1,7 @@
 #include "mock_slave.hpp"
 
 #include <cosim/algorithm.hpp>
+#include <cosim/exception.hpp>
 #include <cosim/execution.hpp>
 #include <cosim/log/simple.hpp>
 #include <cosim/observer/last_value_observer.hpp>
@@ -10,12 +11,16 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 
 // A helper macro to test various assertions
@@ -106,6 +111,49 @@ int main()
         REQUIRE(state_bb_2 == state_bb_imported);
         REQUIRE(state_bb == state_bb_imported);
 
+        std::stringstream binaryNode;
+        binaryNode << cosim::serialization::format::binary << state_bb;
+        cosim::serialization::node state_bb_binary;
+        binaryNode >> cosim::serialization::format::binary >> state_bb_binary;
+        REQUIRE(state_bb_binary == state_bb);
+
+        // Corrupt lengths and nesting depths in binary data are reported as
+        // errors, rather than causing huge allocations or stack overflow.
+        const auto isBadFile = [](const std::string& data) {
+            std::istringstream in(data);
+            try {
+                cosim::serialization::read_binary(in);
+            } catch (const cosim::error& e) {
+                return e.code() == cosim::make_error_code(cosim::errc::bad_file);
+            }
+            return false;
+        };
+        const auto toBinary = [](const cosim::serialization::node& data) {
+            std::ostringstream out;
+            cosim::serialization::write_binary(out, data);
+            return out.str();
+        };
+        const auto hugeLength = [](std::string data, auto length) {
+            // Overwrite the length following the type tag, and drop the rest.
+            std::memcpy(&data[1], &length, sizeof(length));
+            return data.substr(0, 1 + sizeof(length));
+        };
+        cosim::serialization::node blobNode;
+        blobNode.data() = std::vector<std::byte>();
+        REQUIRE(isBadFile(hugeLength(toBinary(blobNode), std::uint64_t(1) << 60)));
+        cosim::serialization::node stringNode;
+        stringNode.data() = std::string();
+        REQUIRE(isBadFile(hugeLength(toBinary(stringNode), std::uint32_t(0xFFFFFFFF))));
+        std::string deepData;
+        for (int i = 0; i < 100000; ++i) {
+            // An empty value (type tag 0), one child, and an empty key.
+            deepData += std::string(1, '\0');
+            const std::uint64_t childCount = 1;
+            deepData.append(reinterpret_cast<const char*>(&childCount), sizeof(childCount));
+            deepData += std::string(sizeof(std::uint32_t), '\0');
+        }
+        REQUIRE(isBadFile(deepData));
+
 
         // ================================================================
         // == Mockup tests
@@ -213,6 +261,17 @@ int main()
         REQUIRE(execution.current_time() == time2);
         auto state2ValuesAgain = get_reals(*observer, simulators, realOutRef);
         REQUIRE(state2ValuesAgain == state2Values);
+
+        // Export state2 in the binary format, advance, and restore it again
+        std::stringstream binaryState2;
+        execution.export_current_state(binaryState2);
+        execution.simulate_until(time2 + 4 * stepSize);
+        REQUIRE(get_reals(*observer, simulators, realOutRef) > state2Values);
+
+        execution.import_state(binaryState2);
+        REQUIRE(execution.current_time() == time2);
+        REQUIRE(get_reals(*observer, simulators, realOutRef) == state2Values);
+        REQUIRE(execution.export_current_state() == state2);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
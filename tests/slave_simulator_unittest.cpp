@@ -1,4 +1,6 @@
 #define BOOST_TEST_MODULE cosim::slave_simulator unittest
+#include "mock_slave.hpp"
+
 #include <cosim/fmi/importer.hpp>
 #include <cosim/fmi/fmu.hpp>
 #include <cosim/fs_portability.hpp>
@@ -6,6 +8,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <memory>
+#include <sstream>
+
 
 BOOST_AUTO_TEST_CASE(slave_simulator_save_state)
 {
@@ -78,3 +83,89 @@ BOOST_AUTO_TEST_CASE(slave_simulator_save_state)
     sim.release_state(state1New);
     sim.release_state(state3);
 }
+
+
+BOOST_AUTO_TEST_CASE(slave_simulator_periodic_getting)
+{
+    auto sim = cosim::slave_simulator(
+        std::make_shared<mock_slave>(
+            [](cosim::time_point t, cosim::duration, double) { return cosim::to_double_time_point(t); },
+            [](cosim::time_point t, cosim::duration, int) { return static_cast<int>(cosim::to_double_time_point(t)); }),
+        "testSlave");
+    const auto realSlot = sim.expose_for_periodic_getting(
+        cosim::variable_type::real, mock_slave::real_out_reference, 2);
+    const auto intSlot = sim.expose_for_getting(
+        cosim::variable_type::integer, mock_slave::integer_out_reference);
+
+    auto t = cosim::time_point();
+    const auto dt = cosim::to_duration(1.0);
+    sim.setup(t, {}, {});
+    sim.start_simulation();
+
+    // The real variable is only retrieved after even-numbered steps, while
+    // the integer variable is retrieved after every step.
+    for (cosim::step_number n = 1; n <= 4; ++n) {
+        sim.set_next_step_number(n);
+        sim.do_step(t, dt);
+        t += dt;
+        BOOST_TEST(sim.get_integer(intSlot) == n);
+        BOOST_TEST(sim.get_real(realSlot) == static_cast<double>(n - n % 2));
+    }
+
+    // Without a step number, everything is retrieved.
+    sim.do_step(t, dt);
+    t += dt;
+    BOOST_TEST(sim.get_real(realSlot) == 5.0);
+
+    // Exposing the variable again with a coprime period means that it must
+    // be retrieved after every step.
+    BOOST_TEST(sim.expose_for_periodic_getting(
+                   cosim::variable_type::real, mock_slave::real_out_reference, 3)
+                   .index == realSlot.index);
+    sim.set_next_step_number(7);
+    sim.do_step(t, dt);
+    BOOST_TEST(sim.get_real(realSlot) == 6.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(slave_simulator_periodic_getting_after_import)
+{
+    auto sim = cosim::slave_simulator(
+        std::make_shared<mock_slave>(
+            [](cosim::time_point t, cosim::duration, double) { return cosim::to_double_time_point(t); },
+            [](cosim::time_point t, cosim::duration, int) { return static_cast<int>(cosim::to_double_time_point(t)); }),
+        "testSlave");
+    const auto realSlot = sim.expose_for_periodic_getting(
+        cosim::variable_type::real, mock_slave::real_out_reference, 2);
+    const auto intSlot = sim.expose_for_getting(
+        cosim::variable_type::integer, mock_slave::integer_out_reference);
+
+    auto t = cosim::time_point();
+    const auto dt = cosim::to_duration(1.0);
+    sim.setup(t, {}, {});
+    sim.start_simulation();
+    sim.set_next_step_number(1);
+    sim.do_step(t, dt);
+    t += dt;
+    const auto state = sim.save_state();
+    const auto exportedState = sim.export_state(state);
+    std::stringstream binaryState;
+    sim.export_state_binary(state, binaryState);
+
+    // Importing a state must not change how often variables are retrieved,
+    // with either of the serialization formats.
+    const auto importedStates = {
+        sim.import_state(exportedState),
+        sim.import_state_binary(binaryState)};
+    for (const auto importedState : importedStates) {
+        sim.restore_state(importedState);
+        auto tn = t;
+        for (cosim::step_number n = 2; n <= 5; ++n) {
+            sim.set_next_step_number(n);
+            sim.do_step(tn, dt);
+            tn += dt;
+            BOOST_TEST(sim.get_integer(intSlot) == n);
+            BOOST_TEST(sim.get_real(realSlot) == static_cast<double>(n - n % 2));
+        }
+    }
+}
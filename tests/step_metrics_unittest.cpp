@@ -0,0 +1,143 @@
+#define BOOST_TEST_MODULE step_metrics unittests
+#include "mock_slave.hpp"
+
+#include <cosim/algorithm/fixed_step_algorithm.hpp>
+#include <cosim/execution.hpp>
+#include <cosim/function/linear_transformation.hpp>
+#include <cosim/observer/last_value_observer.hpp>
+#include <cosim/step_metrics.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+
+BOOST_AUTO_TEST_CASE(duration_histogram)
+{
+    using namespace std::chrono_literals;
+    auto histogram = cosim::duration_histogram(10);
+
+    auto snapshot = histogram.read();
+    BOOST_TEST(snapshot.count == 0u);
+    BOOST_TEST(snapshot.mean().count() == 0);
+
+    histogram.record(500ns); // bucket 0
+    histogram.record(1us);   // bucket 1
+    histogram.record(3us);   // bucket 2
+    histogram.record(100s);  // last bucket
+    snapshot = histogram.read();
+    BOOST_TEST(snapshot.count == 4u);
+    BOOST_TEST(snapshot.counts[0] == 1u);
+    BOOST_TEST(snapshot.counts[1] == 1u);
+    BOOST_TEST(snapshot.counts[2] == 1u);
+    BOOST_TEST(snapshot.counts[cosim::duration_histogram::bucket_count - 1] == 1u);
+    BOOST_TEST(snapshot.total.count() == cosim::duration(100s + 4us + 500ns).count());
+    BOOST_TEST(snapshot.percentile(0.5).count() == cosim::duration(2us).count());
+    BOOST_TEST(snapshot.percentile(0.75).count() == cosim::duration(4us).count());
+    BOOST_TEST(snapshot.percentile(1.0).count() == cosim::duration::max().count());
+    BOOST_TEST(histogram.last().count() == cosim::duration(100s).count());
+
+    // The window holds between 5 and 10 samples, so the old ones should
+    // eventually be forgotten.
+    for (int i = 0; i < 10; ++i) histogram.record(1ms);
+    snapshot = histogram.read();
+    BOOST_TEST(snapshot.count >= 5u);
+    BOOST_TEST(snapshot.count <= 10u);
+    BOOST_TEST(snapshot.count == snapshot.counts[10]);
+    BOOST_TEST(snapshot.mean().count() == cosim::duration(1ms).count());
+    BOOST_TEST(histogram.total_count() == 14u);
+}
+
+
+BOOST_AUTO_TEST_CASE(step_metrics_in_execution)
+{
+    using namespace std::chrono_literals;
+    constexpr auto stepSize = std::chrono::milliseconds(100);
+    constexpr auto stepCount = 10;
+
+    auto execution = cosim::execution(
+        cosim::time_point(),
+        std::make_shared<cosim::fixed_step_algorithm>(stepSize));
+    execution.add_observer(std::make_shared<cosim::last_value_observer>());
+    const auto fast = execution.add_slave(std::make_shared<mock_slave>(), "fast");
+    const auto slow = execution.add_slave(
+        std::make_shared<mock_slave>(
+            [](double x) { return x; },
+            nullptr,
+            nullptr,
+            nullptr,
+            [] { std::this_thread::sleep_for(2ms); }),
+        "slow");
+    const auto fun = execution.add_function(
+        std::make_shared<cosim::linear_transformation_function>(1.0, 2.0));
+    execution.connect_variables(
+        cosim::variable_id{fast, cosim::variable_type::real, mock_slave::real_out_reference},
+        cosim::variable_id{slow, cosim::variable_type::real, mock_slave::real_in_reference});
+    execution.connect_variables(
+        cosim::variable_id{slow, cosim::variable_type::real, mock_slave::real_out_reference},
+        cosim::function_io_id{fun, cosim::variable_type::real, cosim::linear_transformation_function::in_io_reference});
+    execution.initialize();
+
+    const auto metrics = execution.get_step_metrics();
+    BOOST_TEST_REQUIRE(metrics->simulator_count() == 2u);
+
+    // Nothing is recorded while disabled
+    execution.step();
+    BOOST_TEST(metrics->step.total_count() == 0u);
+    BOOST_TEST(metrics->simulator(slow).do_step.total_count() == 0u);
+
+    execution.enable_step_metrics();
+    for (int i = 0; i < stepCount; ++i) execution.step();
+    execution.enable_step_metrics(false);
+    execution.step();
+
+    for (const auto histogram : {
+             &cosim::step_metrics::step,
+             &cosim::step_metrics::functions,
+             &cosim::step_metrics::transfers,
+             &cosim::step_metrics::observers,
+             &cosim::step_metrics::manipulators}) {
+        BOOST_TEST(((*metrics).*histogram).total_count() == std::uint64_t(stepCount));
+    }
+    for (const auto index : {fast, slow}) {
+        const auto& sm = metrics->simulator(index);
+        BOOST_TEST(sm.set_variables.total_count() == std::uint64_t(stepCount));
+        BOOST_TEST(sm.do_step.total_count() == std::uint64_t(stepCount));
+        BOOST_TEST(sm.get_variables.total_count() == std::uint64_t(stepCount));
+    }
+    BOOST_TEST(metrics->simulator(slow).do_step.read().mean().count() >= cosim::duration(2ms).count());
+    BOOST_TEST(metrics->simulator(fast).do_step.read().mean().count() < cosim::duration(2ms).count());
+    BOOST_TEST(metrics->step.read().mean().count() >= cosim::duration(2ms).count());
+}
+
+
+BOOST_AUTO_TEST_CASE(step_metrics_with_pipelined_stepping)
+{
+    constexpr auto stepCount = 10;
+
+    const auto algorithm = std::make_shared<cosim::fixed_step_algorithm>(
+        std::chrono::milliseconds(100));
+    algorithm->set_pipelined_stepping(true);
+    auto execution = cosim::execution(cosim::time_point(), algorithm);
+    const auto source = execution.add_slave(std::make_shared<mock_slave>(), "source");
+    const auto target = execution.add_slave(std::make_shared<mock_slave>(), "target");
+    const auto fun = execution.add_function(
+        std::make_shared<cosim::linear_transformation_function>(1.0, 2.0));
+    execution.connect_variables(
+        cosim::variable_id{source, cosim::variable_type::real, mock_slave::real_out_reference},
+        cosim::variable_id{target, cosim::variable_type::real, mock_slave::real_in_reference});
+    execution.connect_variables(
+        cosim::variable_id{source, cosim::variable_type::real, mock_slave::real_out_reference},
+        cosim::function_io_id{fun, cosim::variable_type::real, cosim::linear_transformation_function::in_io_reference});
+    execution.initialize();
+
+    execution.enable_step_metrics();
+    for (int i = 0; i < stepCount; ++i) execution.step();
+
+    // Pipelined transfers and function calculations are recorded too.
+    const auto metrics = execution.get_step_metrics();
+    BOOST_TEST(metrics->functions.total_count() == std::uint64_t(stepCount));
+    BOOST_TEST(metrics->transfers.total_count() == std::uint64_t(stepCount));
+}
@@ -69,6 +69,23 @@ int main()
             REQUIRE(std::fabs(realValues2[i] - expectedReals2[i]) < 1.0e9);
         }
 
+        // Read the same pair of series, and its reverse, in one batch
+        double batchValues[4][numSamples];
+        const cosim::synchronized_real_series_query queries[] = {
+            {simIndex1, varIndex, simIndex2, varIndex, 5, batchValues[0], batchValues[1]},
+            {simIndex2, varIndex, simIndex1, varIndex, 5, batchValues[2], batchValues[3]},
+        };
+        std::size_t batchSamplesRead[2];
+        observer->get_synchronized_real_series(queries, batchSamplesRead);
+        REQUIRE(batchSamplesRead[0] == samplesRead);
+        REQUIRE(batchSamplesRead[1] == samplesRead);
+        for (size_t i = 0; i < samplesRead; i++) {
+            REQUIRE(batchValues[0][i] == realValues1[i]);
+            REQUIRE(batchValues[1][i] == realValues2[i]);
+            REQUIRE(batchValues[2][i] == realValues2[i]);
+            REQUIRE(batchValues[3][i] == realValues1[i]);
+        }
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -102,6 +102,15 @@ int main()
 
         samplesRead = bufferedObserver->get_real_samples(simIndex, varIndex, 20, gsl::make_span(realValues, numSamples), gsl::make_span(steps, numSamples), gsl::make_span(times, numSamples));
         REQUIRE(samplesRead == 3);
+        REQUIRE(steps[0] == 28 && steps[1] == 29 && steps[2] == 30);
+
+        // Only the last 3 samples are retained
+        bufferedObserver->get_step_numbers(simIndex, cosim::to_duration(10.0), gsl::make_span(stepNumbers, 2));
+        REQUIRE(stepNumbers[0] == 28 && stepNumbers[1] == 30);
+        bufferedObserver->get_step_numbers(simIndex, cosim::to_time_point(2.85), endTime, gsl::make_span(stepNumbers, 2));
+        REQUIRE(stepNumbers[0] == 28 && stepNumbers[1] == 30);
+        observer->get_step_numbers(simIndex, cosim::to_time_point(1.05), cosim::to_time_point(1.45), gsl::make_span(stepNumbers, 2));
+        REQUIRE(stepNumbers[0] == 10 && stepNumbers[1] == 15);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -1,10 +1,14 @@
 #define BOOST_TEST_MODULE cosim::utility unittests
 #include <cosim/utility/concurrency.hpp>
 #include <cosim/utility/filesystem.hpp>
+#include <cosim/utility/fork_join_pool.hpp>
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 /*
  *  A generalised shared mutex testing function.
@@ -70,3 +74,33 @@ BOOST_AUTO_TEST_CASE(file_lock)
         [&] { return cosim::utility::file_lock(workDir.path() / "lockfile2"); },
         [&] { return cosim::utility::file_lock(workDir.path() / "lockfile3"); });
 }
+
+
+BOOST_AUTO_TEST_CASE(fork_join_pool)
+{
+    for (const unsigned int spinCount : {0u, cosim::utility::fork_join_pool::default_spin_count}) {
+        cosim::utility::fork_join_pool pool(3, spinCount);
+        BOOST_TEST(pool.thread_count() == 3u);
+
+        std::vector<int> counts(10);
+        for (int r = 0; r < 1000; ++r) {
+            pool.run(counts.size(), [&](std::size_t i) { ++counts[i]; });
+        }
+        for (const auto c : counts) BOOST_TEST(c == 1000);
+
+        // Fewer tasks than threads
+        std::atomic<int> sum = 0;
+        pool.run(2, [&](std::size_t i) { sum += static_cast<int>(i) + 1; });
+        BOOST_TEST(sum == 3);
+
+        // Exceptions are propagated, and the pool is still usable afterwards
+        BOOST_CHECK_THROW(
+            pool.run(8, [](std::size_t i) {
+                if (i == 5) throw std::runtime_error("task failed");
+            }),
+            std::runtime_error);
+        sum = 0;
+        pool.run(8, [&](std::size_t) { ++sum; });
+        BOOST_TEST(sum == 8);
+    }
+}
@@ -3,12 +3,91 @@
 #include <cosim/utility/filesystem.hpp>
 #include <cosim/utility/zip.hpp>
 
+#include <boost/crc.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
 #include <system_error>
 
 
+namespace
+{
+std::string read_file(const cosim::filesystem::path& path)
+{
+    std::ifstream file(path.string(), std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Writes a little-endian integer of the given size to `out`.
+void put(std::ostream& out, std::uint32_t value, int size)
+{
+    for (int i = 0; i < size; ++i) out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+// Writes a zip archive with a single, uncompressed file entry.
+void write_single_entry_zip(
+    const cosim::filesystem::path& path,
+    const std::string& name,
+    const std::string& contents)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(contents.data(), contents.size());
+    const auto size = static_cast<std::uint32_t>(contents.size());
+    const auto nameSize = static_cast<std::uint32_t>(name.size());
+
+    std::ofstream out(path.string(), std::ios_base::binary);
+    // Local file header
+    put(out, 0x04034b50, 4);
+    put(out, 20, 2); // version needed to extract
+    put(out, 0, 2); // flags
+    put(out, 0, 2); // compression method (stored)
+    put(out, 0, 2); // modification time
+    put(out, 0x21, 2); // modification date (1980-01-01)
+    put(out, crc.checksum(), 4);
+    put(out, size, 4);
+    put(out, size, 4);
+    put(out, nameSize, 2);
+    put(out, 0, 2); // extra field length
+    out << name << contents;
+    // Central directory
+    const auto centralDirOffset = 30 + nameSize + size;
+    put(out, 0x02014b50, 4);
+    put(out, 20, 2); // version made by
+    put(out, 20, 2); // version needed to extract
+    put(out, 0, 2);
+    put(out, 0, 2);
+    put(out, 0, 2);
+    put(out, 0x21, 2);
+    put(out, crc.checksum(), 4);
+    put(out, size, 4);
+    put(out, size, 4);
+    put(out, nameSize, 2);
+    put(out, 0, 2); // extra field length
+    put(out, 0, 2); // comment length
+    put(out, 0, 2); // disk number
+    put(out, 0, 2); // internal attributes
+    put(out, 0, 4); // external attributes
+    put(out, 0, 4); // local header offset
+    out << name;
+    // End of central directory
+    put(out, 0x06054b50, 4);
+    put(out, 0, 2);
+    put(out, 0, 2);
+    put(out, 1, 2);
+    put(out, 1, 2);
+    put(out, 46 + nameSize, 4);
+    put(out, centralDirOffset, 4);
+    put(out, 0, 2); // comment length
+}
+} // namespace
+
+
 BOOST_AUTO_TEST_CASE(zip_archive)
 {
     namespace ut = cosim::utility;
@@ -25,6 +104,8 @@ BOOST_AUTO_TEST_CASE(zip_archive)
     const std::string txtName = txtFilename;
     const std::uint64_t binSize = 16489;
     const std::uint64_t txtSize = 13;
+    const std::uint32_t binCrc32 = 812298436;
+    const std::string txtContents = "Hello\nWorld!\n";
 
     // Test setup
     const auto testDataDir = std::getenv("TEST_DATA_DIR");
@@ -75,6 +156,37 @@ BOOST_AUTO_TEST_CASE(zip_archive)
         BOOST_CHECK_THROW(archive.extract_file_to(binIndex, tempDir.path() / "nonexistent"), std::system_error);
     }
 
+    // Extract selected entries
+    {
+        ut::temp_dir tempDir;
+        archive.extract_matching(
+            tempDir.path(),
+            [&](std::string_view name) { return name == binName; },
+            4);
+        const auto binExtracted = tempDir.path() / binName;
+        BOOST_TEST_REQUIRE(fs::exists(binExtracted));
+        BOOST_TEST(fs::file_size(binExtracted) == binSize);
+        BOOST_TEST(!fs::exists(tempDir.path() / txtName));
+    }
+
+    // Extract all files in parallel, regardless of their size
+    {
+        ut::temp_dir tempDir;
+        archive.extract_matching(tempDir.path(), nullptr, 4, 0);
+        const auto binExtracted = tempDir.path() / binName;
+        const auto txtExtracted = tempDir.path() / txtName;
+        BOOST_TEST_REQUIRE(fs::exists(binExtracted));
+        BOOST_TEST_REQUIRE(fs::exists(txtExtracted));
+        BOOST_TEST(fs::is_directory(tempDir.path() / dirName));
+
+        const auto binData = read_file(binExtracted);
+        BOOST_TEST(binData.size() == binSize);
+        boost::crc_32_type binCrc;
+        binCrc.process_bytes(binData.data(), binData.size());
+        BOOST_TEST(binCrc.checksum() == binCrc32);
+        BOOST_TEST(read_file(txtExtracted) == txtContents);
+    }
+
     // Extract individual entries
     {
         ut::temp_dir tempDir;
@@ -92,3 +204,24 @@ BOOST_AUTO_TEST_CASE(zip_archive)
     BOOST_TEST(!archive.is_open());
     BOOST_CHECK_NO_THROW(archive.discard());
 }
+
+
+BOOST_AUTO_TEST_CASE(zip_archive_rejects_parent_path_entries)
+{
+    namespace ut = cosim::utility;
+    namespace uz = cosim::utility::zip;
+    namespace fs = cosim::filesystem;
+
+    ut::temp_dir tempDir;
+    const auto archivePath = tempDir.path() / "escape.zip";
+    write_single_entry_zip(archivePath, "sub/../../escaped.txt", "escaped");
+    const auto targetDir = tempDir.path() / "target";
+    fs::create_directory(targetDir);
+
+    auto archive = uz::archive(archivePath);
+    BOOST_TEST_REQUIRE(archive.entry_count() == 1u);
+    BOOST_CHECK_THROW(archive.extract_all(targetDir), uz::error);
+    BOOST_CHECK_THROW(archive.extract_matching(targetDir, nullptr, 4, 0), uz::error);
+    BOOST_TEST(!fs::exists(tempDir.path() / "escaped.txt"));
+    BOOST_TEST(!fs::exists(targetDir / "sub"));
+}